@@ -59,7 +59,7 @@ private:
     int caretFlashTimer = 0;
     const int caretFlashInterval = 30; //frames
 
-    MulticastEvent<std::string, LogSystem::Level>::Listener* logMessageListener = nullptr;
-    MulticastEvent<std::string>::Listener* windowTextReceivedListener = nullptr;
-    MulticastEvent<class Input*>::Listener* windowKeyInputListener = nullptr;
+    MulticastEvent<std::string, LogSystem::Level>::Connection logMessageConnection;
+    MulticastEvent<std::string>::Connection windowTextReceivedConnection;
+    MulticastEvent<class Input*>::Connection windowKeyInputConnection;
 };
\ No newline at end of file
@@ -18,7 +18,7 @@ uint8_t colors[(int)LogSystem::Level::Max] = {
 Console::Console(Engine* engine)
     : engine(engine) {
 
-    logMessageListener = &engine->GetSystem<LogSystem>()->MessageLogged.Connect(
+    logMessageConnection = engine->GetSystem<LogSystem>()->MessageLogged.Connect(
         [this](const std::string& message, LogSystem::Level level) {
             bool isScrolledToBottom = (windowY + windowLines) >= (int)messages.size();
 
@@ -37,7 +37,7 @@ Console::~Console() {
 }
 void Console::OnAttached(Viewport* viewport) {
 
-    windowTextReceivedListener = &viewport->GetAttachedWindow()->ReceivedTextInput.Connect(
+    windowTextReceivedConnection = viewport->GetAttachedWindow()->ReceivedTextInput.Connect(
         [this](const std::string& text) {
             if (!IsEnabled()) {
                 return;
@@ -61,7 +61,7 @@ void Console::OnAttached(Viewport* viewport) {
         return;
     }
 
-    windowKeyInputListener = &inputSystem->InputBegan.Connect(
+    windowKeyInputConnection = inputSystem->InputBegan.Connect(
         [this](Input* input) {
             KeyCode key = input->Key;
             InputState state = input->State;
@@ -148,7 +148,8 @@ void Console::OnAttached(Viewport* viewport) {
     );
 }
 void Console::OnDetached(Viewport* viewport) {
-
+    windowTextReceivedConnection.Disconnect();
+    windowKeyInputConnection.Disconnect();
 }
 void Console::OnRendered(Viewport* viewport) {
 
@@ -14,8 +14,8 @@ public:
     AssetSystem(Engine* engine);
     ~AssetSystem();
 
-    void Initialize();
-    void Shutdown();
+    void Initialize() override;
+    void Shutdown() override;
 
     AssetHandle LoadAssetById(uint64_t assetId);
     AssetHandle LoadAsset(const std::string& assetURI);
@@ -0,0 +1,41 @@
+#include "Core/CollectionSystem.h"
+#include "Core/Engine.h"
+#include <stdexcept>
+
+std::vector<Instance*> CollectionSystem::GetInstancesOfClass(std::string_view className, bool includeSubclasses) {
+    Reflection::Class* cls = Reflection::GetRegistry().GetClass(className);
+    if (!cls) {
+        throw std::runtime_error("Unknown class: " + std::string(className));
+    }
+    std::vector<Instance*> instances;
+    engine->GetInstanceRegistry().GetInstancesOfClass(cls, instances, includeSubclasses);
+    return instances;
+}
+
+void CollectionSystem::AddTag(Instance* instance, std::string tag) {
+    if (!instance) {
+        throw std::runtime_error("Cannot tag a nil instance");
+    }
+    engine->GetInstanceRegistry().AddTag(instance, tag);
+}
+
+void CollectionSystem::RemoveTag(Instance* instance, std::string tag) {
+    if (instance) {
+        engine->GetInstanceRegistry().RemoveTag(instance, tag);
+    }
+}
+
+bool CollectionSystem::HasTag(Instance* instance, std::string tag) {
+    return instance && engine->GetInstanceRegistry().HasTag(instance, tag);
+}
+
+std::vector<Instance*> CollectionSystem::GetTagged(std::string tag) {
+    return engine->GetInstanceRegistry().GetTagged(tag);
+}
+
+std::vector<std::string> CollectionSystem::GetTags(Instance* instance) {
+    if (!instance) {
+        return {};
+    }
+    return engine->GetInstanceRegistry().GetTags(instance);
+}
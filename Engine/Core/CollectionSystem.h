@@ -0,0 +1,45 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Core/Export.h"
+#include "Instance/System.h"
+#include "CollectionSystem.generated.h"
+
+class Engine;
+
+/// Script-facing view of the engine's InstanceRegistry: every live instance by class, plus free-form tags.
+/// C++ code can use Engine::GetInstanceRegistry() directly and avoid the copies made here.
+class GP_EXPORT [[reflect()]] CollectionSystem : public System, BaseInstance<CollectionSystem> {
+    REFLECTION()
+public:
+    CollectionSystem(Engine* engine) : System(engine) {}
+
+    [[reflect()]]
+    [[summary("Returns every live instance of the given class. If includeSubclasses is true (the default), instances of classes deriving from it are included. Does not walk the tree.")]]
+    std::vector<Instance*> GetInstancesOfClass(std::string_view className, bool includeSubclasses = true);
+
+    [[reflect()]]
+    [[summary("Adds a tag to the instance. Does nothing if the instance already has it. Tags are dropped when the instance is destroyed.")]]
+    void AddTag(Instance* instance, std::string tag);
+
+    [[reflect()]]
+    [[summary("Removes a tag from the instance. Does nothing if the instance does not have it.")]]
+    void RemoveTag(Instance* instance, std::string tag);
+
+    [[reflect()]]
+    [[summary("Returns true if the instance has the given tag, false otherwise.")]]
+    bool HasTag(Instance* instance, std::string tag);
+
+    [[reflect()]]
+    [[summary("Returns every live instance with the given tag, in no particular order.")]]
+    std::vector<Instance*> GetTagged(std::string tag);
+
+    [[reflect()]]
+    [[summary("Returns the tags on the instance, in the order they were added.")]]
+    std::vector<std::string> GetTags(Instance* instance);
+};
+
+REFLECTION_END()
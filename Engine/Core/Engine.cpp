@@ -4,81 +4,18 @@
 #include "Instance/Reflection.h"
 #include "UI/UISystem.h"
 #include "Rendering/IRenderer.h"
-#include <unordered_map>
 #include "ReflectionRegistry.h"
 #include "Platform/Viewport.h"
 
-void SystemInitOrder::Before(System* system, std::string_view beforeSystemName) {
-	rules.push_back({ system, beforeSystemName, SystemRelation::Before });
-}
-void SystemInitOrder::After(System* system, std::string_view afterSystemName) {
-	rules.push_back({ system, afterSystemName, SystemRelation::After });
-}
-void SystemInitOrder::Add(System* system) {
-	rules.push_back({ system, "", SystemRelation::None });
-}
-
-std::vector<System*> SystemInitOrder::Resolve() const {
-	std::unordered_map<std::string_view, System*> systemsByName;
-	for (const Rule& rule : rules) {
-		if (rule.relation != SystemRelation::None) {
-			systemsByName[rule.system->ClassName()] = rule.system;
-		}
-	}
-
-	//Now, process the rules in order.
-	std::vector<System*> orderedSystems;
-	std::deque<Rule> pendingRules = rules;
-
-	//Keep processing until no more rules can be applied.
-	bool progressMade = true;
-	while (progressMade && !pendingRules.empty()) {
-		progressMade = false;
-		Rule& rule = pendingRules.front();
-
-		if (rule.relation == SystemRelation::None) {
-			//No dependencies, can add directly.
-			orderedSystems.push_back(rule.system);
-			pendingRules.pop_front();
-			progressMade = true;
-		} else {
-			//Has a dependency, check if it's already in the ordered list.
-			auto it = systemsByName.find(rule.relativeToName);
-			if (it != systemsByName.end()) {
-				System* relativeSystem = it->second;
-				auto posIt = std::find(orderedSystems.begin(), orderedSystems.end(), relativeSystem);
-				if (posIt != orderedSystems.end()) {
-					//Found the relative system in the ordered list.
-					if (rule.relation == SystemRelation::Before) {
-						orderedSystems.insert(posIt, rule.system);
-					} else { //After
-						orderedSystems.insert(posIt + 1, rule.system);
-					}
-					pendingRules.pop_front();
-					progressMade = true;
-				} else {
-					//Relative system not yet added, move this rule to the back of the queue.
-					pendingRules.push_back(rule);
-					pendingRules.pop_front();
-				}
-			} else {
-				//Relative system not found, treat as no dependency.
-				orderedSystems.push_back(rule.system);
-				pendingRules.pop_front();
-				progressMade = true;
-			}
-		}
-	}
-
-	return orderedSystems;
-}
-
 Engine::Engine(Engine* engine) : Instance(this) {
-
+	//Instance's constructor runs before instanceIndex exists, so the engine files itself here.
+	instanceIndex.Insert(Id, this);
 }
 
 Engine::~Engine() {
-
+	releaseDestroyed();
+	//Instances outliving the engine must not try to reach its journal.
+	propertyChangeJournal.Clear();
 }
 
 void Engine::Initialize(const EngineInitParams& params) {
@@ -99,21 +36,22 @@ void Engine::Initialize(const EngineInitParams& params) {
 	//Look up all the classes that derive from System and create them.
 	SystemInitOrder initOrder;
 
-	for (const auto& classEntry : Reflection::GetRegistry().classes) {
-		Reflection::Class* cls = classEntry.second;
-		if (cls->IsA("System") && cls->className != "System") {
+	Reflection::Class* systemClass = &System::StaticClass();
+	for (Reflection::Class* cls : Reflection::GetRegistry().GetClasses()) {
+		if (cls != systemClass && cls->IsA(systemClass)) {
 			//Create an instance of the system.
 			System* system = cls->InstantiateAs<System>(this);
 			if (system) {
 				systems[cls->className] = system;
-				
+
+				initOrder.Add(system);
 				system->Register(initOrder);
 			}
 		}
 	}
 	
-	orderedSystems = initOrder.Resolve();
-	for (System* system : orderedSystems) {
+	systemScheduler.Build(initOrder);
+	for (System* system : systemScheduler.GetOrder()) {
 		system->Initialize();
 	}
 	systemsInitialized = true;
@@ -150,9 +88,22 @@ void Engine::Update() {
 	double deltaTime = now - lastFrameStart;
 	lastFrameStart = now;
 
-	for (System* system : orderedSystems) {
-		system->Update(deltaTime);
+	systemScheduler.Run(deltaTime);
+	//Results workers handed back to the simulation thread, applied before this frame's changes flush.
+	jobSystem.RunMainThreadJobs();
+
+	propertyChangeJournal.Flush();
+	snapshotPublisher.Publish(*this, now);
+	releaseDestroyed();
+	instanceIndex.ReclaimRetired();
+}
+
+void Engine::releaseDestroyed() {
+	//Children before their parents: an object's destructor still reaches into its World's TransformStore.
+	for (auto it = pendingDestroy.rbegin(); it != pendingDestroy.rend(); ++it) {
+		freeInstance(*it);
 	}
+	pendingDestroy.clear();
 }
 
 void Engine::registerViewport(Viewport* viewport) {
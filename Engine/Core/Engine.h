@@ -2,7 +2,6 @@
 #include <map>
 #include <type_traits>
 #include <string_view>
-#include <deque>
 #include "Core/Export.h"
 #include "Instance/Instance.h"
 #include "Instance/System.h"
@@ -10,6 +9,13 @@
 #include "Scripting/LuaState.h"
 #include "Core/TimeProvider.h"
 #include "Core/IFileSystemWatcher.h"
+#include "Core/PropertyChangeJournal.h"
+#include "Core/EngineSnapshot.h"
+#include "Core/InstanceIdIndex.h"
+#include "Core/InstanceRegistry.h"
+#include "Core/JobSystem.h"
+#include "Core/SystemScheduler.h"
+#include "Utility/LRUCache.h"
 #include "Engine.generated.h"
 
 namespace Rendering {
@@ -17,26 +23,11 @@ namespace Rendering {
 }
 
 class Engine;
-class SystemInitOrder {
-protected:
-	friend class Engine;
-	enum class SystemRelation {
-		None,
-		Before,
-		After
-	};
-	struct Rule {
-		System* system;
-		std::string_view relativeToName;
-		SystemRelation relation;
-	};
-
-	std::deque<Rule> rules;
-	std::vector<System*> Resolve() const;
-public:
-	void Before(System* system, std::string_view beforeSystemName);
-	void After(System* system, std::string_view afterSystemName);
-	void Add(System* system);
+
+/// A cached Instance::FindFirstDescendantByPath result, trusted while the engine's path lookup version is unchanged.
+struct PathLookup {
+	EngineUUID id;
+	uint64_t version;
 };
 
 struct EngineInitParams {
@@ -85,7 +76,62 @@ public:
 		return fileSystemWatcher;
 	}
 
+	/// Property changes raised during the frame, delivered at the end of Update().
+	PropertyChangeJournal& GetPropertyChangeJournal() {
+		return propertyChangeJournal;
+	}
+
+	/// Every live instance created with this engine, by Id.
+	InstanceIdIndex& GetInstanceIndex() {
+		return instanceIndex;
+	}
+	/// The live instance with the given Id, or nullptr. Safe to call from any thread.
+	Instance* FindInstance(const EngineUUID& id) const {
+		return instanceIndex.Find(id);
+	}
+	/// Every live instance created with this engine, by class and by tag.
+	InstanceRegistry& GetInstanceRegistry() {
+		return instanceRegistry;
+	}
+	/// The hot state as of the end of the last Update(). Safe to call from any thread.
+	std::shared_ptr<const EngineSnapshot> GetSnapshot() const {
+		return snapshotPublisher.Acquire();
+	}
+	/// Recent Instance::FindFirstDescendantByPath results, keyed by the root's Id followed by the path.
+	LRUCache<std::string, PathLookup>& GetPathLookupCache() {
+		return pathLookupCache;
+	}
+	/// Bumped whenever a rename or removal may change which of several same-named siblings comes first, which
+	/// makes every cached path lookup from before it stale.
+	uint64_t GetPathLookupVersion() const {
+		return pathLookupVersion;
+	}
+	void InvalidatePathLookups() {
+		pathLookupVersion++;
+	}
+
 	void Update();
+
+	/// Worker threads shared by the engine and its systems. See JobSystem.
+	JobSystem& GetJobSystem() {
+		return jobSystem;
+	}
+
+	/// Where each system's Update() ran during the last frame, in initialization order.
+	std::span<const SystemTiming> GetSystemTimings() const {
+		return systemScheduler.GetTimings();
+	}
+
+	/// Takes instances passed to Instance::Destroy() this frame, each subtree parents first. They are freed together
+	/// at the end of Update(), after the change journal has flushed and the frame's snapshot is published.
+	void QueueDestroyed(std::span<Instance* const> instances) {
+		pendingDestroy.insert(pendingDestroy.end(), instances.begin(), instances.end());
+	}
+	size_t GetPendingDestroyCount() const {
+		return pendingDestroy.size();
+	}
+
+	static constexpr size_t PathLookupCacheCapacity = 1024;
 protected:
 	ITimeProvider* timeProvider = nullptr;
 	IFileSystemWatcher* fileSystemWatcher = nullptr;
@@ -100,9 +146,20 @@ protected:
 
 	Lua::State* consoleState = nullptr;
 
+	PropertyChangeJournal propertyChangeJournal;
+	SnapshotPublisher snapshotPublisher{ propertyChangeJournal };
+	InstanceIdIndex instanceIndex;
+	InstanceRegistry instanceRegistry;
+	LRUCache<std::string, PathLookup> pathLookupCache{ PathLookupCacheCapacity };
+	uint64_t pathLookupVersion = 0;
+	std::vector<Instance*> pendingDestroy;
+
+	void releaseDestroyed();
+
 	bool systemsInitialized = false;
 	std::map<std::string_view, System*> systems;
-	std::vector<System*> orderedSystems;
+	JobSystem jobSystem;
+	SystemScheduler systemScheduler{ jobSystem };
 
 	std::vector<class Viewport*> viewports;
 	friend class Viewport;
@@ -0,0 +1,80 @@
+#include "Core/EngineSnapshot.h"
+#include "Core/Engine.h"
+#include "Instance/World.h"
+#include "Instance/ObjectInstance.h"
+
+const WorldTransformSnapshot* EngineSnapshot::FindWorld(const EngineUUID& worldId) const {
+    for (const std::shared_ptr<const WorldTransformSnapshot>& world : worlds) {
+        if (world->worldId == worldId) {
+            return world.get();
+        }
+    }
+    return nullptr;
+}
+
+SnapshotPublisher::SnapshotPublisher(PropertyChangeJournal& journal) : cursor(journal.MakeCursor()) {
+    published.store(std::make_shared<const EngineSnapshot>(), std::memory_order_release);
+}
+
+void SnapshotPublisher::Publish(Engine& engine, double time) {
+    std::shared_ptr<const EngineSnapshot> previous = published.load(std::memory_order_relaxed);
+    std::shared_ptr<EngineSnapshot> snapshot = std::make_shared<EngineSnapshot>();
+    snapshot->frame = ++frame;
+    snapshot->time = time;
+
+    engine.GetInstanceRegistry().ForEachOfClass<World>([&](World* world) {
+        const TransformStore& store = std::as_const(*world).GetTransformStore();
+        for (const std::shared_ptr<const WorldTransformSnapshot>& last : previous->worlds) {
+            if (last->worldId == world->Id && last->storeVersion == store.GetVersion()) {
+                snapshot->worlds.push_back(last);
+                return;
+            }
+        }
+
+        std::shared_ptr<WorldTransformSnapshot> copy = acquireWorldBuffer();
+        copy->worldId = world->Id;
+        copy->storeVersion = store.GetVersion();
+        copy->ids.clear();
+        for (ObjectInstance* owner : store.GetOwners()) {
+            copy->ids.push_back(owner->Id);
+        }
+        for (size_t i = 0; i < TransformStore::ComponentCount; i++) {
+            std::span<const double> component = store.GetComponent(static_cast<TransformStore::Component>(i));
+            copy->components[i].assign(component.begin(), component.end());
+        }
+        snapshot->worlds.push_back(std::move(copy));
+    });
+
+    snapshot->changesComplete = engine.GetPropertyChangeJournal().Collect(cursor, [&](Instance* instance, uint64_t dirtyProps) {
+        snapshot->changes.push_back({ instance->Id, instance->GetClass(), dirtyProps });
+    });
+
+    size_t worldCount = snapshot->worlds.size();
+    published.store(std::move(snapshot), std::memory_order_release);
+    previous.reset();
+
+    //Keep one free buffer per world for the next frame and let go of the rest.
+    size_t spare = worldCount;
+    std::erase_if(worldBuffers, [&](const std::shared_ptr<WorldTransformSnapshot>& buffer) {
+        if (buffer.use_count() != 1) {
+            return false;
+        }
+        if (spare > 0) {
+            spare--;
+            return false;
+        }
+        return true;
+    });
+}
+
+std::shared_ptr<WorldTransformSnapshot> SnapshotPublisher::acquireWorldBuffer() {
+    for (const std::shared_ptr<WorldTransformSnapshot>& buffer : worldBuffers) {
+        if (buffer.use_count() == 1) {
+            //The last reader let go on another thread, its reads must be finished before we overwrite.
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return buffer;
+        }
+    }
+    worldBuffers.push_back(std::make_shared<WorldTransformSnapshot>());
+    return worldBuffers.back();
+}
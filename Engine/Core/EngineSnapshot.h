@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+#include "Core/Export.h"
+#include "Core/PropertyChangeJournal.h"
+#include "Instance/TransformStore.h"
+#include "Instance/UUID.h"
+
+class Engine;
+
+namespace Reflection {
+    struct Class;
+}
+
+/// Copy of one World's TransformStore as it was when a snapshot was published. Entries are in store
+/// order and identified by instance Id rather than pointer, since the instance may be gone by the
+/// time a reader looks.
+struct WorldTransformSnapshot {
+    EngineUUID worldId;
+    /// TransformStore::GetVersion() of the store this was copied from.
+    uint64_t storeVersion = 0;
+    std::vector<EngineUUID> ids;
+    std::vector<double> components[TransformStore::ComponentCount];
+
+    size_t GetCount() const { return ids.size(); }
+    std::span<const double> GetComponent(TransformStore::Component component) const { return components[component]; }
+};
+
+/// An instance whose properties changed during the frame, see PropertyChangeJournal::Collect().
+struct PropertyChangeSnapshot {
+    EngineUUID id;
+    const Reflection::Class* cls;
+    /// Bit i stands for cls->propertyTable.properties[i].
+    uint64_t dirtyProps;
+};
+
+/// Immutable view of the engine's hot state at the end of one Engine::Update().
+struct EngineSnapshot {
+    uint64_t frame = 0;
+    double time = 0.0;
+    /// One per World. Worlds whose transforms did not change share their entry with the previous snapshot.
+    std::vector<std::shared_ptr<const WorldTransformSnapshot>> worlds;
+    /// Properties changed during this frame only.
+    std::vector<PropertyChangeSnapshot> changes;
+    /// False if the frame's changes could not be collected and changes is incomplete.
+    bool changesComplete = true;
+
+    const WorldTransformSnapshot* FindWorld(const EngineUUID& worldId) const;
+};
+
+/// Publishes an EngineSnapshot at the end of every Engine::Update(), so rendering, replication and
+/// analytics can read the last finished frame from other threads while the simulation thread works
+/// on the next one. Readers take a reference with Acquire() and keep it as long as they like; the
+/// snapshot never changes underneath them and they never wait for the simulation thread.
+///
+/// Building a snapshot is copy-on-write per World: a world whose TransformStore version is unchanged
+/// reuses the previous snapshot's copy. Copies no reader holds any more are recycled, so in steady
+/// state the same two buffers per world alternate and copying transforms does not allocate.
+class GP_EXPORT SnapshotPublisher {
+public:
+    /// Takes a cursor on journal straight away, so changes from the very first frame are reported.
+    explicit SnapshotPublisher(PropertyChangeJournal& journal);
+    SnapshotPublisher(const SnapshotPublisher&) = delete;
+    SnapshotPublisher& operator=(const SnapshotPublisher&) = delete;
+
+    /// Builds and publishes the snapshot for the frame that just ended. Simulation thread only, after
+    /// the property change journal has been flushed.
+    void Publish(Engine& engine, double time);
+
+    /// The latest published snapshot. Safe to call from any thread. Never null.
+    std::shared_ptr<const EngineSnapshot> Acquire() const {
+        return published.load(std::memory_order_acquire);
+    }
+
+    uint64_t GetFrame() const { return frame; }
+
+private:
+    std::atomic<std::shared_ptr<const EngineSnapshot>> published;
+    /// Every world copy made so far. Those only referenced from here are free to be overwritten.
+    std::vector<std::shared_ptr<WorldTransformSnapshot>> worldBuffers;
+    PropertyChangeJournal::Cursor cursor;
+    uint64_t frame = 0;
+
+    std::shared_ptr<WorldTransformSnapshot> acquireWorldBuffer();
+};
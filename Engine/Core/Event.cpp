@@ -0,0 +1,123 @@
+#include "Core/Event.h"
+#include <stdexcept>
+
+//This thread's released slots. Whatever is left when the thread ends goes back to the shared list; thread-local
+//objects are destroyed before the table, which is a function-local static.
+struct EventConnectionTable::LocalFreeSlots {
+    std::vector<uint32_t> slots;
+
+    ~LocalFreeSlots() {
+        if (!slots.empty()) {
+            EventConnectionTable& table = GetEventConnections();
+            std::lock_guard<std::mutex> guard(table.sharedMutex);
+            table.sharedFree.insert(table.sharedFree.end(), slots.begin(), slots.end());
+        }
+    }
+};
+
+EventConnectionTable::~EventConnectionTable() {
+    for (std::atomic<Entry*>& chunk : chunks) {
+        delete[] chunk.load(std::memory_order_relaxed);
+    }
+}
+
+EventConnectionTable::LocalFreeSlots& EventConnectionTable::localFreeSlots() {
+    thread_local LocalFreeSlots local;
+    return local;
+}
+
+EventConnectionTable::Entry* EventConnectionTable::find(uint32_t slot) const {
+    if ((slot >> ChunkShift) >= MaxChunks) {
+        return nullptr;
+    }
+    Entry* chunk = chunks[slot >> ChunkShift].load(std::memory_order_acquire);
+    return chunk ? &chunk[slot & (ChunkSize - 1)] : nullptr;
+}
+
+uint32_t EventConnectionTable::newSlot() {
+    uint32_t slot = slotCount.fetch_add(1, std::memory_order_relaxed);
+    if ((slot >> ChunkShift) >= MaxChunks) {
+        slotCount.fetch_sub(1, std::memory_order_relaxed);
+        throw std::runtime_error("Too many event listeners connected");
+    }
+    std::atomic<Entry*>& chunk = chunks[slot >> ChunkShift];
+    if (!chunk.load(std::memory_order_acquire)) {
+        //Whoever takes a chunk's first slot might not be the first here, so race to publish it.
+        Entry* created = new Entry[ChunkSize];
+        Entry* expected = nullptr;
+        if (!chunk.compare_exchange_strong(expected, created, std::memory_order_acq_rel)) {
+            delete[] created;
+        }
+    }
+    return slot;
+}
+
+EventConnectionTable::Handle EventConnectionTable::Acquire(void* event, DisconnectFn disconnect, uint32_t id) {
+    std::vector<uint32_t>& local = localFreeSlots().slots;
+    if (local.empty()) {
+        std::lock_guard<std::mutex> guard(sharedMutex);
+        size_t take = std::min(sharedFree.size(), LocalFreeLimit / 2);
+        local.insert(local.end(), sharedFree.end() - take, sharedFree.end());
+        sharedFree.resize(sharedFree.size() - take);
+    }
+    uint32_t slot;
+    if (!local.empty()) {
+        slot = local.back();
+        local.pop_back();
+    } else {
+        slot = newSlot();
+    }
+
+    //The slot is released, so its generation is even and no handle matches it while the fields change.
+    Entry& entry = *find(slot);
+    uint32_t generation = entry.generation.load(std::memory_order_relaxed) + 1;
+    std::atomic_thread_fence(std::memory_order_release);
+    entry.event.store(event, std::memory_order_relaxed);
+    entry.disconnect.store(disconnect, std::memory_order_relaxed);
+    entry.id.store(id, std::memory_order_relaxed);
+    entry.generation.store(generation, std::memory_order_release);
+    return { slot, generation };
+}
+
+void EventConnectionTable::Release(uint32_t slot) {
+    Entry& entry = *find(slot);
+    entry.generation.store(entry.generation.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+    std::vector<uint32_t>& local = localFreeSlots().slots;
+    local.push_back(slot);
+    if (local.size() > LocalFreeLimit) {
+        //Keep the most recently released ones, they are the likeliest to still be in cache.
+        size_t give = LocalFreeLimit / 2;
+        std::lock_guard<std::mutex> guard(sharedMutex);
+        sharedFree.insert(sharedFree.end(), local.begin(), local.begin() + give);
+        local.erase(local.begin(), local.begin() + give);
+    }
+}
+
+bool EventConnectionTable::Disconnect(uint32_t slot, uint32_t generation) {
+    Entry* entry = find(slot);
+    if (!entry || entry->generation.load(std::memory_order_acquire) != generation) {
+        return false;
+    }
+    void* event = entry->event.load(std::memory_order_relaxed);
+    DisconnectFn disconnect = entry->disconnect.load(std::memory_order_relaxed);
+    uint32_t id = entry->id.load(std::memory_order_relaxed);
+    //If the slot was released and taken again meanwhile, what was just read may belong to someone else.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (entry->generation.load(std::memory_order_relaxed) != generation) {
+        return false;
+    }
+    //The event releases the slot itself.
+    disconnect(event, id);
+    return true;
+}
+
+bool EventConnectionTable::IsConnected(uint32_t slot, uint32_t generation) const {
+    Entry* entry = find(slot);
+    return entry && entry->generation.load(std::memory_order_acquire) == generation;
+}
+
+EventConnectionTable& GetEventConnections() {
+    static EventConnectionTable table;
+    return table;
+}
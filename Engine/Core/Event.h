@@ -1,106 +1,439 @@
 #pragma once
-#include <functional>
-#include <list>
 #include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "Core/Export.h"
 
+template<typename Signature>
+class InlineFunction;
+
+/// Move-only type-erased callable. Callables of up to InlineSize bytes (a lambda capturing `this` and
+/// a pointer or two) live inside the object; anything larger, over-aligned or throwing on move goes to the heap.
+template<typename R, typename... Args>
+class InlineFunction<R(Args...)> {
+public:
+	static constexpr size_t InlineSize = 2 * sizeof(void*);
+
+	InlineFunction() = default;
+
+	template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, InlineFunction>>>
+	InlineFunction(F&& callable) {
+		using Stored = std::decay_t<F>;
+		if constexpr (fitsInline<Stored>()) {
+			new (storage) Stored(std::forward<F>(callable));
+			ops = &inlineOps<Stored>;
+		} else {
+			new (storage) Stored*(new Stored(std::forward<F>(callable)));
+			ops = &heapOps<Stored>;
+		}
+	}
+
+	InlineFunction(InlineFunction&& other) noexcept {
+		moveFrom(other);
+	}
+	InlineFunction& operator=(InlineFunction&& other) noexcept {
+		if (this != &other) {
+			reset();
+			moveFrom(other);
+		}
+		return *this;
+	}
+	InlineFunction(const InlineFunction&) = delete;
+	InlineFunction& operator=(const InlineFunction&) = delete;
+
+	~InlineFunction() {
+		reset();
+	}
+
+	R operator()(Args... args) {
+		return ops->invoke(storage, std::forward<Args>(args)...);
+	}
+
+	explicit operator bool() const { return ops != nullptr; }
+
+	void reset() {
+		if (ops) {
+			ops->destroy(storage);
+			ops = nullptr;
+		}
+	}
+
+private:
+	struct Ops {
+		R (*invoke)(void* storage, Args&&... args);
+		/// Move-constructs into dst and destroys src.
+		void (*relocate)(void* dst, void* src);
+		void (*destroy)(void* storage);
+	};
+
+	template<typename F>
+	static constexpr bool fitsInline() {
+		return sizeof(F) <= InlineSize && alignof(F) <= alignof(void*) && std::is_nothrow_move_constructible_v<F>;
+	}
+
+	template<typename F>
+	static constexpr Ops inlineOps = {
+		[](void* storage, Args&&... args) -> R {
+			return (*static_cast<F*>(storage))(std::forward<Args>(args)...);
+		},
+		[](void* dst, void* src) {
+			new (dst) F(std::move(*static_cast<F*>(src)));
+			static_cast<F*>(src)->~F();
+		},
+		[](void* storage) {
+			static_cast<F*>(storage)->~F();
+		}
+	};
+
+	template<typename F>
+	static constexpr Ops heapOps = {
+		[](void* storage, Args&&... args) -> R {
+			return (**static_cast<F**>(storage))(std::forward<Args>(args)...);
+		},
+		[](void* dst, void* src) {
+			new (dst) F*(*static_cast<F**>(src));
+		},
+		[](void* storage) {
+			delete *static_cast<F**>(storage);
+		}
+	};
+
+	alignas(void*) std::byte storage[InlineSize];
+	const Ops* ops = nullptr;
+
+	void moveFrom(InlineFunction& other) {
+		if (other.ops) {
+			other.ops->relocate(storage, other.storage);
+			ops = other.ops;
+			other.ops = nullptr;
+		}
+	}
+};
+
+/// Process-wide table giving every connected listener a slot, so a MulticastEvent::Connection can be checked
+/// without touching the event it came from. A slot's generation is bumped when its listener is disconnected or
+/// its event is destroyed, after which handles taken before then no longer match and do nothing, even if the
+/// event's memory has since been reused by another event.
+///
+/// Every instance event goes through here, from any thread, so none of it takes a lock in the common case.
+/// Slots live in fixed-size chunks that never move, generations are atomic (odd while connected, even once
+/// released), and each thread keeps its own released slots and reuses them LIFO. Only a thread with too many
+/// or too few of them trades a batch with the shared list, under a mutex.
+class GP_EXPORT EventConnectionTable {
+public:
+	static constexpr uint32_t NoSlot = ~0u;
+	using DisconnectFn = void (*)(void* event, uint32_t id);
+
+	struct Handle {
+		uint32_t slot;
+		uint32_t generation;
+	};
+
+	EventConnectionTable() = default;
+	~EventConnectionTable();
+	EventConnectionTable(const EventConnectionTable&) = delete;
+	EventConnectionTable& operator=(const EventConnectionTable&) = delete;
+
+	/// Takes a slot for a listener of event and returns it with its generation. Throws std::runtime_error if
+	/// every slot is in use.
+	Handle Acquire(void* event, DisconnectFn disconnect, uint32_t id);
+	void Release(uint32_t slot);
+
+	/// Disconnects the listener in slot if generation still matches. Returns false if it was already gone.
+	bool Disconnect(uint32_t slot, uint32_t generation);
+	bool IsConnected(uint32_t slot, uint32_t generation) const;
+
+private:
+	static constexpr uint32_t ChunkShift = 10;
+	static constexpr uint32_t ChunkSize = 1u << ChunkShift;
+	static constexpr uint32_t MaxChunks = 1u << 14;
+	/// Released slots a thread keeps before handing half of them to the shared list.
+	static constexpr size_t LocalFreeLimit = 256;
+
+	struct Entry {
+		//Written by the thread acquiring the slot and read by Disconnect(), which checks the generation
+		//on both sides of the read to make sure they belonged to its listener.
+		std::atomic<void*> event{ nullptr };
+		std::atomic<DisconnectFn> disconnect{ nullptr };
+		std::atomic<uint32_t> id{ 0 };
+		std::atomic<uint32_t> generation{ 0 };
+	};
+	struct LocalFreeSlots;
+
+	std::atomic<Entry*> chunks[MaxChunks] = {};
+	std::atomic<uint32_t> slotCount{ 0 };
+	std::mutex sharedMutex;
+	std::vector<uint32_t> sharedFree;
+
+	static LocalFreeSlots& localFreeSlots();
+	Entry* find(uint32_t slot) const;
+	uint32_t newSlot();
+};
+
+GP_EXPORT EventConnectionTable& GetEventConnections();
+
+/// Event with any number of listeners, fired synchronously in connection order.
+/// The first InlineListeners listeners are stored inside the event itself, so an event with no listeners
+/// (or only a few) never touches the heap; beyond that listeners live in one contiguous array.
+/// Disconnecting leaves a tombstone that is compacted away once nothing is firing, so listeners may
+/// connect or disconnect (including themselves) from inside a callback. Listeners connected while the
+/// event is firing are first called on the next Fire.
+/// Events are neither copyable nor movable, since connections refer back to them.
 template<typename... ArgTypes>
 class MulticastEvent {
 public:
-	struct Listener {
-		Listener() = default;
-		~Listener() {
-			//Disconnect();
-		}
+	using Callback = InlineFunction<void(ArgTypes...)>;
+	static constexpr uint32_t InlineListeners = 1;
 
-		MulticastEvent<ArgTypes...>* event = nullptr;
-		std::function<void(ArgTypes...)> callback = nullptr;
-		bool isBound = false;
-		bool isOnce = false;
+	/// Handle to one connected listener: a slot in the EventConnectionTable and the generation it had when the
+	/// listener connected. Once the listener is disconnected, or has fired if it was a Once listener, or its event
+	/// is destroyed, the handle stops matching, so a stale handle never disconnects somebody else's listener and
+	/// is safe to use after the event is gone.
+	class Connection {
+	public:
+		Connection() = default;
 
 		void Disconnect() {
-			if (event) event->Disconnect(this);
+			if (slot != EventConnectionTable::NoSlot) {
+				GetEventConnections().Disconnect(slot, generation);
+				slot = EventConnectionTable::NoSlot;
+			}
+		}
+		bool IsConnected() const {
+			return slot != EventConnectionTable::NoSlot && GetEventConnections().IsConnected(slot, generation);
 		}
+
+	private:
+		friend class MulticastEvent;
+		Connection(uint32_t _slot, uint32_t _generation) : slot(_slot), generation(_generation) {}
+
+		uint32_t slot = EventConnectionTable::NoSlot;
+		uint32_t generation = 0;
 	};
 
+	MulticastEvent() = default;
+	MulticastEvent(const MulticastEvent&) = delete;
+	MulticastEvent& operator=(const MulticastEvent&) = delete;
+
 	~MulticastEvent() {
-		isDestructing = true;
-		listeners.clear();
+		releaseSlots(entries, count);
+		releaseSlots(pending.data(), static_cast<uint32_t>(pending.size()));
+		destroyEntries(entries, count);
+		if (entries != inlineEntries()) {
+			::operator delete(entries, std::align_val_t(alignof(Entry)));
+		}
+	}
+
+	template<typename F>
+	Connection Connect(F&& callback) {
+		return add(Callback(std::forward<F>(callback)), false);
+	}
+
+	/// Like Connect, but the listener is disconnected right before its first call.
+	template<typename F>
+	Connection Once(F&& callback) {
+		return add(Callback(std::forward<F>(callback)), true);
+	}
+
+	void Disconnect(Connection& connection) {
+		connection.Disconnect();
+	}
+
+	/// Disconnects every listener, including ones connected during the current Fire.
+	void DisconnectAll() {
+		for (uint32_t i = 0; i < count; i++) {
+			if (entries[i].alive) {
+				kill(entries[i]);
+			}
+		}
+		//Pending listeners disconnected earlier were counted out already.
+		for (Entry& entry : pending) {
+			if (entry.alive) {
+				kill(entry);
+			}
+		}
 		pending.clear();
+		if (firingDepth == 0) {
+			compact();
+		}
+	}
+
+	void Fire(ArgTypes... args) {
+		if (liveCount == 0) {
+			return;
+		}
+		FiringScope scope(*this);
+		//Only listeners present when firing began; new ones wait in pending, so entries cannot move under us.
+		uint32_t firingCount = count;
+		for (uint32_t i = 0; i < firingCount; i++) {
+			Entry& entry = entries[i];
+			if (!entry.alive) {
+				continue;
+			}
+			if (entry.isOnce) {
+				kill(entry);
+			}
+			entry.callback(args...);
+		}
 	}
 
-	Listener& Connect(std::function<void(ArgTypes...)> callback) {
-		Listener listener;
-		listener.event = this;
-		listener.callback = callback;
-		listener.isBound = true;
-		listener.isOnce = false;
+	inline bool HasAnyListeners() const { return liveCount != 0; }
+	inline uint32_t GetListenerCount() const { return liveCount; }
+
+private:
+	struct Entry {
+		Callback callback;
+		uint32_t id;
+		/// Slot in GetEventConnections() while alive.
+		uint32_t slot;
+		bool isOnce;
+		bool alive;
+	};
+
+	struct FiringScope {
+		MulticastEvent& event;
+		explicit FiringScope(MulticastEvent& _event) : event(_event) { event.firingDepth++; }
+		~FiringScope() {
+			if (--event.firingDepth == 0) {
+				event.afterFiring();
+			}
+		}
+	};
+
+	Entry* entries = inlineEntries();
+	uint32_t count = 0;
+	uint32_t capacity = InlineListeners;
+	uint32_t liveCount = 0;
+	uint32_t deadCount = 0;
+	uint32_t nextId = 1;
+	uint32_t firingDepth = 0;
+	std::vector<Entry> pending;
+	alignas(Entry) std::byte inlineStorage[sizeof(Entry) * InlineListeners];
+
+	Entry* inlineEntries() {
+		return reinterpret_cast<Entry*>(inlineStorage);
+	}
 
-		if (!isFiring) {
-			listeners.push_back(listener);
-			return listeners.back();
+	Connection add(Callback&& callback, bool isOnce) {
+		uint32_t id = nextId++;
+		EventConnectionTable& connections = GetEventConnections();
+		EventConnectionTable::Handle handle = connections.Acquire(this, &MulticastEvent::disconnectThunk, id);
+		if (firingDepth > 0) {
+			pending.push_back({ std::move(callback), id, handle.slot, isOnce, true });
 		} else {
-			pending.push_back(listener);
-			return pending.back();
+			append({ std::move(callback), id, handle.slot, isOnce, true });
 		}
+		liveCount++;
+		return Connection(handle.slot, handle.generation);
 	}
 
-	Listener& Once(std::function<void(ArgTypes...)> callback) {
-		Listener listener;
-		listener.event = this;
-		listener.callback = callback;
-		listener.isBound = true;
-		listener.isOnce = true;
+	static void disconnectThunk(void* event, uint32_t id) {
+		static_cast<MulticastEvent*>(event)->disconnect(id);
+	}
 
-		if (!isFiring) {
-			listeners.push_back(listener);
-			return listeners.back();
-		} else {
-			pending.push_back(listener);
-			return pending.back();
+	static void releaseSlots(Entry* begin, uint32_t n) {
+		for (uint32_t i = 0; i < n; i++) {
+			if (begin[i].alive) {
+				GetEventConnections().Release(begin[i].slot);
+			}
+		}
+	}
+
+	void append(Entry&& entry) {
+		if (count == capacity) {
+			grow();
 		}
+		new (&entries[count]) Entry(std::move(entry));
+		count++;
 	}
 
-	void Disconnect(Listener* listener) {
-		if (!listener) return;
-		listener->isBound = false;
-		if (isFiring) {
-			//do not alter the list while firing the event.
-			//simply mark it as unbound.
+	void grow() {
+		uint32_t newCapacity = capacity * 2;
+		Entry* newEntries = static_cast<Entry*>(::operator new(sizeof(Entry) * newCapacity, std::align_val_t(alignof(Entry))));
+		for (uint32_t i = 0; i < count; i++) {
+			new (&newEntries[i]) Entry(std::move(entries[i]));
+		}
+		destroyEntries(entries, count);
+		if (entries != inlineEntries()) {
+			::operator delete(entries, std::align_val_t(alignof(Entry)));
+		}
+		entries = newEntries;
+		capacity = newCapacity;
+	}
+
+	static void destroyEntries(Entry* begin, uint32_t n) {
+		for (uint32_t i = 0; i < n; i++) {
+			begin[i].~Entry();
+		}
+	}
+
+	/// Ids are handed out in increasing order and compaction keeps the order, so both arrays stay sorted by id.
+	static Entry* findIn(Entry* begin, Entry* end, uint32_t id) {
+		Entry* it = std::lower_bound(begin, end, id, [](const Entry& entry, uint32_t value) { return entry.id < value; });
+		return (it != end && it->id == id && it->alive) ? it : nullptr;
+	}
+	Entry* find(uint32_t id) {
+		Entry* entry = findIn(entries, entries + count, id);
+		if (!entry && !pending.empty()) {
+			entry = findIn(pending.data(), pending.data() + pending.size(), id);
+		}
+		return entry;
+	}
+
+	void kill(Entry& entry) {
+		GetEventConnections().Release(entry.slot);
+		entry.alive = false;
+		liveCount--;
+		deadCount++;
+		if (firingDepth == 0) {
+			//Nothing can be running this callback, release its captures now.
+			entry.callback.reset();
+		}
+	}
+
+	void disconnect(uint32_t id) {
+		Entry* entry = find(id);
+		if (!entry) {
 			return;
 		}
-		cleanupUnbound();
+		kill(*entry);
+		if (firingDepth == 0 && deadCount * 2 >= count) {
+			compact();
+		}
 	}
 
-	void Fire(ArgTypes... args) {
-		isFiring = true;
-		for (auto& listener : listeners) {
-			if (listener.isBound) {
-				listener.callback(args...);
-			}
-			if (listener.isOnce) {
-				listener.isBound = false;
+	void afterFiring() {
+		if (!pending.empty()) {
+			for (Entry& entry : pending) {
+				append(std::move(entry));
 			}
+			pending.clear();
+		}
+		if (deadCount > 0) {
+			compact();
 		}
-		isFiring = false;
-
-		cleanupPending();
-		cleanupUnbound();
 	}
 
-	inline bool HasAnyListeners() const { return !listeners.empty(); }
-private:
-	std::list<Listener> listeners;
-	std::list<Listener> pending;
-	bool isFiring = false;
-	bool isDestructing = false;
-
-	void cleanupPending() {
-		if (isFiring) return;
-		listeners.splice(listeners.end(), pending);
-	}
-	void cleanupUnbound() {
-		if (isFiring) return;
-		listeners.remove_if([](const Listener& l) { return !l.isBound; });
+	void compact() {
+		uint32_t kept = 0;
+		for (uint32_t i = 0; i < count; i++) {
+			if (!entries[i].alive) {
+				continue;
+			}
+			if (kept != i) {
+				entries[kept] = std::move(entries[i]);
+			}
+			kept++;
+		}
+		destroyEntries(entries + kept, count - kept);
+		count = kept;
+		deadCount = 0;
 	}
 };
 
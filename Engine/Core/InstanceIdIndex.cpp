@@ -0,0 +1,142 @@
+#include "Core/InstanceIdIndex.h"
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64)
+#include <emmintrin.h>
+#define GP_INSTANCE_INDEX_SSE2 1
+#endif
+
+InstanceIdIndex::InstanceIdIndex()
+    : owned(std::make_unique<Table>(MinCapacity)) {
+    current.store(owned.get(), std::memory_order_release);
+}
+
+InstanceIdIndex::~InstanceIdIndex() = default;
+
+void InstanceIdIndex::loadKey(const EngineUUID& id, uint64_t key[2]) {
+    std::memcpy(key, id.bytes, EngineUUID::SIZE);
+}
+
+bool InstanceIdIndex::keyEquals(const Slot& slot, const uint64_t key[2]) {
+#ifdef GP_INSTANCE_INDEX_SSE2
+    __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(slot.key));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(key));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) == 0xFFFF;
+#else
+    return slot.key[0] == key[0] && slot.key[1] == key[1];
+#endif
+}
+
+void InstanceIdIndex::Insert(const EngineUUID& id, Instance* instance) {
+    if ((usedCount + 1) * 4 > (current.load(std::memory_order_relaxed)->mask + 1) * 3) {
+        //Size for the live entries only; tombstones are dropped by the rehash.
+        size_t capacity = MinCapacity;
+        while ((liveCount + 1) * 2 > capacity) {
+            capacity *= 2;
+        }
+        rehash(capacity);
+    }
+
+    uint64_t key[2];
+    loadKey(id, key);
+    Table* table = current.load(std::memory_order_relaxed);
+    for (size_t i = id.Hash() & table->mask;; i = (i + 1) & table->mask) {
+        Slot& slot = table->slots[i];
+        Instance* value = slot.value.load(std::memory_order_relaxed);
+        if (!value) {
+            //Readers only look at a key after seeing its value, so the release publishes both.
+            slot.key[0] = key[0];
+            slot.key[1] = key[1];
+            slot.value.store(instance, std::memory_order_release);
+            liveCount++;
+            usedCount++;
+            return;
+        }
+        if (value != tombstone() && keyEquals(slot, key)) {
+            slot.value.store(instance, std::memory_order_release);
+            return;
+        }
+    }
+}
+
+void InstanceIdIndex::Erase(const EngineUUID& id, Instance* instance) {
+    uint64_t key[2];
+    loadKey(id, key);
+    Table* table = current.load(std::memory_order_relaxed);
+    for (size_t i = id.Hash() & table->mask;; i = (i + 1) & table->mask) {
+        Slot& slot = table->slots[i];
+        Instance* value = slot.value.load(std::memory_order_relaxed);
+        if (!value) {
+            return;
+        }
+        if (value != tombstone() && keyEquals(slot, key)) {
+            if (value == instance) {
+                //The key stays in place, slots are never rewritten while readers may be probing them.
+                slot.value.store(tombstone(), std::memory_order_release);
+                liveCount--;
+            }
+            return;
+        }
+    }
+}
+
+Instance* InstanceIdIndex::Find(const EngineUUID& id) const {
+    struct ReaderScope {
+        std::atomic<uint32_t>& readers;
+        ~ReaderScope() { readers.fetch_sub(1, std::memory_order_release); }
+    };
+    uint64_t key[2];
+    loadKey(id, key);
+    //Sequentially consistent with the table swap in rehash() and the check in ReclaimRetired().
+    activeReaders.fetch_add(1, std::memory_order_seq_cst);
+    ReaderScope scope{ activeReaders };
+    const Table* table = current.load(std::memory_order_seq_cst);
+    for (size_t i = id.Hash() & table->mask;; i = (i + 1) & table->mask) {
+        const Slot& slot = table->slots[i];
+        Instance* value = slot.value.load(std::memory_order_acquire);
+        if (!value) {
+            return nullptr;
+        }
+        if (value != tombstone() && keyEquals(slot, key)) {
+            return value;
+        }
+    }
+}
+
+void InstanceIdIndex::rehash(size_t capacity) {
+    std::unique_ptr<Table> table = std::make_unique<Table>(capacity);
+    const Table* old = owned.get();
+    for (size_t i = 0; i <= old->mask; i++) {
+        const Slot& from = old->slots[i];
+        Instance* value = from.value.load(std::memory_order_relaxed);
+        if (!value || value == tombstone()) {
+            continue;
+        }
+        uint64_t hash;
+        {
+            EngineUUID id(reinterpret_cast<const uint8_t*>(from.key));
+            hash = id.Hash();
+        }
+        size_t j = hash & table->mask;
+        while (table->slots[j].value.load(std::memory_order_relaxed)) {
+            j = (j + 1) & table->mask;
+        }
+        Slot& to = table->slots[j];
+        to.key[0] = from.key[0];
+        to.key[1] = from.key[1];
+        to.value.store(value, std::memory_order_relaxed);
+    }
+    usedCount = liveCount;
+
+    //Readers may still be probing the old table, it is freed by ReclaimRetired().
+    current.store(table.get(), std::memory_order_seq_cst);
+    retired.push_back(std::move(owned));
+    owned = std::move(table);
+}
+
+void InstanceIdIndex::ReclaimRetired() {
+    //A reader that counts itself after this sees the current table, not a retired one.
+    if (!retired.empty() && activeReaders.load(std::memory_order_seq_cst) == 0) {
+        retired.clear();
+    }
+}
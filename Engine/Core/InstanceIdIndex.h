@@ -0,0 +1,72 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Core/Export.h"
+#include "Instance/UUID.h"
+
+class Instance;
+
+/// Engine-wide map from Instance::Id to the live instance, kept up to date by the Instance constructor
+/// and destructor. Open addressing with linear probing over 32-byte slots, each holding the 16-byte id
+/// (compared as one SSE2 vector where available) and the instance pointer, so a hit costs one cache line.
+///
+/// Insert and Erase run on the simulation thread only. Find is lock-free and may run on any thread:
+/// a slot's id is written once, before its instance pointer is published, and never rewritten. Erased
+/// slots become tombstones until the next rehash, and a rehash publishes a new table while the old one
+/// is retired. ReclaimRetired(), which Engine::Update calls once per frame, frees retired tables once no
+/// Find() is running, so a reader never probes a freed table.
+class GP_EXPORT InstanceIdIndex {
+public:
+    static constexpr size_t MinCapacity = 64;
+
+    InstanceIdIndex();
+    ~InstanceIdIndex();
+    InstanceIdIndex(const InstanceIdIndex&) = delete;
+    InstanceIdIndex& operator=(const InstanceIdIndex&) = delete;
+
+    /// Files instance under id, replacing whatever was filed under it before.
+    void Insert(const EngineUUID& id, Instance* instance);
+    /// Removes id, but only if it still refers to instance.
+    void Erase(const EngineUUID& id, Instance* instance);
+
+    /// The live instance with the given id, or null. Safe to call from any thread.
+    Instance* Find(const EngineUUID& id) const;
+
+    size_t GetCount() const { return liveCount; }
+    size_t GetCapacity() const { return current.load(std::memory_order_relaxed)->mask + 1; }
+
+    /// Frees tables replaced by growth, unless a Find() is running on another thread, in which case they
+    /// are left for the next call. Simulation thread only.
+    void ReclaimRetired();
+
+private:
+    struct alignas(32) Slot {
+        alignas(16) uint64_t key[2];
+        std::atomic<Instance*> value;
+    };
+    struct Table {
+        size_t mask;
+        std::unique_ptr<Slot[]> slots;
+
+        explicit Table(size_t capacity) : mask(capacity - 1), slots(new Slot[capacity]) {}
+    };
+
+    std::atomic<Table*> current;
+    std::unique_ptr<Table> owned;
+    std::vector<std::unique_ptr<Table>> retired;
+    /// Find() calls in progress. A reader counts itself before loading current, so once this reads zero
+    /// after a table was replaced, nobody can still be holding that table.
+    mutable std::atomic<uint32_t> activeReaders{ 0 };
+    size_t liveCount = 0;
+    /// Live slots plus tombstones. Keeps at least a quarter of the slots empty, which ends every probe.
+    size_t usedCount = 0;
+
+    static Instance* tombstone() { return reinterpret_cast<Instance*>(uintptr_t(1)); }
+    static bool keyEquals(const Slot& slot, const uint64_t key[2]);
+    static void loadKey(const EngineUUID& id, uint64_t key[2]);
+
+    void rehash(size_t capacity);
+};
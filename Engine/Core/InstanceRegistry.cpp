@@ -0,0 +1,161 @@
+#include "Core/InstanceRegistry.h"
+#include <algorithm>
+
+void InstanceRegistry::Track(Instance* instance) {
+    add(instance, PendingList);
+    totalCount++;
+}
+
+void InstanceRegistry::Untrack(Instance* instance) {
+    remove(instance);
+    totalCount--;
+
+    if (instance->registryHook.tagCount > 0) {
+        auto it = tagsByInstance.find(instance);
+        for (const std::string& tag : it->second) {
+            auto entry = tags.find(tag);
+            eraseFromTag(entry->second, instance);
+        }
+        tagsByInstance.erase(it);
+        instance->registryHook.tagCount = 0;
+    }
+}
+
+void InstanceRegistry::add(Instance* instance, uint32_t list) {
+    std::vector<Instance*>& instances = listAt(list).instances;
+    instance->registryHook.list = list;
+    instance->registryHook.position = static_cast<uint32_t>(instances.size());
+    instances.push_back(instance);
+}
+
+void InstanceRegistry::remove(Instance* instance) {
+    std::vector<Instance*>& instances = listAt(instance->registryHook.list).instances;
+    uint32_t position = instance->registryHook.position;
+    Instance* last = instances.back();
+    instances[position] = last;
+    last->registryHook.position = position;
+    instances.pop_back();
+}
+
+void InstanceRegistry::sortPending() {
+    Reflection::Registry& registry = Reflection::GetRegistry();
+    if (!registry.IsFinalized()) {
+        return;
+    }
+    if (generation != registry.GetGeneration()) {
+        //Classes were renumbered, so put everything back through the pending list.
+        for (ClassList& list : lists) {
+            for (Instance* instance : list.instances) {
+                add(instance, PendingList);
+            }
+        }
+        lists.clear();
+        generation = registry.GetGeneration();
+    }
+
+    std::vector<Instance*> waiting;
+    waiting.swap(pending.instances);
+    for (Instance* instance : waiting) {
+        const Reflection::Class* cls = instance->GetClass();
+        if (cls->index == Reflection::Class::InvalidIndex) {
+            //Not finalized yet, try again on the next query.
+            add(instance, PendingList);
+            continue;
+        }
+        if (cls->index >= lists.size()) {
+            lists.resize(cls->index + 1);
+        }
+        lists[cls->index].cls = cls;
+        add(instance, cls->index);
+    }
+}
+
+bool InstanceRegistry::matches(size_t list, const Reflection::Class* cls, bool includeSubclasses) const {
+    const Reflection::Class* listClass = lists[list].cls;
+    return includeSubclasses ? listClass->IsA(cls) : listClass == cls;
+}
+
+void InstanceRegistry::GetInstancesOfClass(const Reflection::Class* cls, std::vector<Instance*>& out, bool includeSubclasses) {
+    out.reserve(out.size() + GetCountOfClass(cls, includeSubclasses));
+    ForEachOfClass(cls, [&](Instance* instance) {
+        out.push_back(instance);
+    }, includeSubclasses);
+}
+
+size_t InstanceRegistry::GetCountOfClass(const Reflection::Class* cls, bool includeSubclasses) {
+    sortPending();
+    size_t count = 0;
+    for (size_t i = 0; i < lists.size(); i++) {
+        if (!lists[i].instances.empty() && matches(i, cls, includeSubclasses)) {
+            count += lists[i].instances.size();
+        }
+    }
+    return count;
+}
+
+bool InstanceRegistry::AddTag(Instance* instance, std::string_view tag) {
+    auto it = tags.find(tag);
+    if (it == tags.end()) {
+        it = tags.emplace(std::string(tag), TagEntry()).first;
+    }
+    TagEntry& entry = it->second;
+    if (!entry.positions.emplace(instance, entry.instances.size()).second) {
+        return false;
+    }
+    entry.instances.push_back(instance);
+    tagsByInstance[instance].push_back(it->first);
+    instance->registryHook.tagCount++;
+    return true;
+}
+
+bool InstanceRegistry::RemoveTag(Instance* instance, std::string_view tag) {
+    auto it = tags.find(tag);
+    if (it == tags.end() || !it->second.positions.count(instance)) {
+        return false;
+    }
+    eraseFromTag(it->second, instance);
+
+    auto owned = tagsByInstance.find(instance);
+    std::vector<std::string>& names = owned->second;
+    names.erase(std::find(names.begin(), names.end(), tag));
+    if (--instance->registryHook.tagCount == 0) {
+        tagsByInstance.erase(owned);
+    }
+    return true;
+}
+
+bool InstanceRegistry::HasTag(const Instance* instance, std::string_view tag) const {
+    if (instance->registryHook.tagCount == 0) {
+        return false;
+    }
+    auto it = tags.find(tag);
+    return it != tags.end() && it->second.positions.count(instance);
+}
+
+const std::vector<Instance*>& InstanceRegistry::GetTagged(std::string_view tag) const {
+    static const std::vector<Instance*> none;
+    auto it = tags.find(tag);
+    return it != tags.end() ? it->second.instances : none;
+}
+
+const std::vector<std::string>& InstanceRegistry::GetTags(const Instance* instance) const {
+    static const std::vector<std::string> none;
+    if (instance->registryHook.tagCount == 0) {
+        return none;
+    }
+    return tagsByInstance.find(instance)->second;
+}
+
+void InstanceRegistry::eraseFromTag(TagEntry& entry, const Instance* instance) {
+    auto it = entry.positions.find(instance);
+    size_t position = it->second;
+    entry.positions.erase(it);
+
+    //Swap the last instance into the hole, so removal does not shift the rest.
+    Instance* last = entry.instances.back();
+    entry.instances.pop_back();
+    if (last != instance) {
+        entry.instances[position] = last;
+        entry.positions[last] = position;
+    }
+}
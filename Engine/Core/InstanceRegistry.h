@@ -0,0 +1,102 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Core/Export.h"
+#include "Instance/Instance.h"
+
+/// Every live instance of an engine, in one dense array per class, so all instances of a class (and its
+/// subclasses) can be found without walking the tree. Instances add themselves from the Instance
+/// constructor and remove themselves from the destructor, so nothing else has to remember to. Each
+/// instance remembers its own slot, which makes removal a swap with the last entry. Arrays rather than
+/// linked lists, so iteration is not one dependent cache miss per instance.
+///
+/// The most derived class is not known yet while Instance's constructor runs, so new instances wait on
+/// a pending list and are moved into their class arrays by the next query. Also keeps the tag index
+/// behind CollectionSystem. Simulation thread only.
+class GP_EXPORT InstanceRegistry {
+public:
+    InstanceRegistry() = default;
+    InstanceRegistry(const InstanceRegistry&) = delete;
+    InstanceRegistry& operator=(const InstanceRegistry&) = delete;
+
+    void Track(Instance* instance);
+    void Untrack(Instance* instance);
+
+    /// Visits every live instance that is cls (or, with includeSubclasses, derives from it). The visitor
+    /// takes an Instance* and may return TraversalAction::Stop to end early. It may destroy the instance
+    /// it was given, but no others. Returns false if the visitor stopped.
+    template<typename Visitor>
+    bool ForEachOfClass(const Reflection::Class* cls, Visitor&& visitor, bool includeSubclasses = true) {
+        sortPending();
+        for (size_t i = 0; i < lists.size(); i++) {
+            if (lists[i].instances.empty() || !matches(i, cls, includeSubclasses)) {
+                continue;
+            }
+            //Backwards, so destroying the visited instance only swaps in one that was already visited.
+            for (size_t j = lists[i].instances.size(); j-- > 0;) {
+                if (Instance::visit(visitor, lists[i].instances[j]) == TraversalAction::Stop) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    template<typename T, typename Visitor>
+    bool ForEachOfClass(Visitor&& visitor, bool includeSubclasses = true) {
+        return ForEachOfClass(&T::StaticClass(), [&](Instance* node) {
+            return Instance::visit(visitor, static_cast<T*>(node));
+        }, includeSubclasses);
+    }
+
+    /// Appends every live instance of cls (or of its subclasses too) to out.
+    void GetInstancesOfClass(const Reflection::Class* cls, std::vector<Instance*>& out, bool includeSubclasses = true);
+    size_t GetCountOfClass(const Reflection::Class* cls, bool includeSubclasses = true);
+    size_t GetCount() const { return totalCount; }
+
+    /// Returns false if the instance already had the tag.
+    bool AddTag(Instance* instance, std::string_view tag);
+    /// Returns false if the instance did not have the tag.
+    bool RemoveTag(Instance* instance, std::string_view tag);
+    bool HasTag(const Instance* instance, std::string_view tag) const;
+    /// Live instances carrying the tag, in no particular order. Invalidated by any tag change.
+    const std::vector<Instance*>& GetTagged(std::string_view tag) const;
+    /// Tags on the instance, in the order they were added.
+    const std::vector<std::string>& GetTags(const Instance* instance) const;
+
+private:
+    static constexpr uint32_t PendingList = ~0u;
+
+    struct ClassList {
+        std::vector<Instance*> instances;
+        const Reflection::Class* cls = nullptr;
+    };
+    struct TagEntry {
+        std::vector<Instance*> instances;
+        std::unordered_map<const Instance*, size_t> positions;
+    };
+    struct StringHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view value) const { return std::hash<std::string_view>{}(value); }
+    };
+
+    ClassList pending;
+    std::vector<ClassList> lists;
+    size_t totalCount = 0;
+    /// Registry generation the lists are indexed for. A later Finalize() may renumber classes.
+    uint32_t generation = 0;
+
+    std::unordered_map<std::string, TagEntry, StringHash, std::equal_to<>> tags;
+    std::unordered_map<const Instance*, std::vector<std::string>> tagsByInstance;
+
+    ClassList& listAt(uint32_t list) { return list == PendingList ? pending : lists[list]; }
+    void add(Instance* instance, uint32_t list);
+    void remove(Instance* instance);
+    void sortPending();
+    bool matches(size_t list, const Reflection::Class* cls, bool includeSubclasses) const;
+    void eraseFromTag(TagEntry& entry, const Instance* instance);
+};
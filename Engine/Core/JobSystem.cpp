@@ -0,0 +1,187 @@
+#include "Core/JobSystem.h"
+
+namespace {
+    //Which pool, if any, the current thread works for.
+    thread_local const JobSystem* currentJobSystem = nullptr;
+    thread_local uint32_t currentWorkerIndex = 0;
+}
+
+JobSystem::JobSystem(size_t workerCount) : mainThreadId(std::this_thread::get_id()) {
+    for (size_t i = 0; i < workerCount; i++) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    //Only start them once every deque exists, they steal from each other straight away.
+    for (size_t i = 0; i < workerCount; i++) {
+        workers[i]->thread = std::thread(&JobSystem::workerLoop, this, static_cast<uint32_t>(i + 1));
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> guard(sleepMutex);
+        stopping = true;
+    }
+    sleep.notify_all();
+    for (std::unique_ptr<Worker>& worker : workers) {
+        worker->thread.join();
+    }
+}
+
+size_t JobSystem::defaultWorkerCount() {
+    unsigned int cores = std::thread::hardware_concurrency();
+    return cores > 2 ? cores - 1 : 1;
+}
+
+uint32_t JobSystem::GetCurrentThreadIndex() const {
+    return currentJobSystem == this ? currentWorkerIndex : 0;
+}
+
+void JobSystem::Submit(std::function<void()> function, JobCounter* counter, Affinity affinity) {
+    if (counter) {
+        counter->pending.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (affinity == Affinity::MainThread) {
+        std::lock_guard<std::mutex> guard(sharedMutex);
+        mainThreadJobs.push_back({ std::move(function), counter });
+        mainThreadQueued.fetch_add(1, std::memory_order_release);
+    } else if (uint32_t index = GetCurrentThreadIndex(); index > 0) {
+        Worker& worker = *workers[index - 1];
+        std::lock_guard<std::mutex> guard(worker.mutex);
+        worker.jobs.push_back({ std::move(function), counter });
+        queued.fetch_add(1, std::memory_order_release);
+    } else {
+        std::lock_guard<std::mutex> guard(sharedMutex);
+        sharedJobs.push_back({ std::move(function), counter });
+        queued.fetch_add(1, std::memory_order_release);
+    }
+    //Only the main thread can take a main-thread job, so make sure it is among those woken.
+    notify(affinity == Affinity::MainThread);
+}
+
+void JobSystem::Wait(JobCounter& counter) {
+    int32_t worker = static_cast<int32_t>(GetCurrentThreadIndex()) - 1;
+    bool mainThread = IsMainThread();
+    while (!counter.IsDone()) {
+        Job job;
+        if (take(job, worker, mainThread)) {
+            run(job);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleep.wait(lock, [&]() {
+            return counter.IsDone() || queued.load(std::memory_order_acquire) > 0 ||
+                (mainThread && mainThreadQueued.load(std::memory_order_acquire) > 0);
+        });
+    }
+    if (counter.failed.load(std::memory_order_acquire)) {
+        std::exception_ptr error = counter.error;
+        counter.error = nullptr;
+        counter.failed.store(false, std::memory_order_relaxed);
+        std::rethrow_exception(error);
+    }
+}
+
+void JobSystem::RunMainThreadJobs() {
+    Job job;
+    while (take(job, -1, true)) {
+        run(job);
+    }
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> guard(sharedMutex);
+        std::swap(error, uncountedError);
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void JobSystem::workerLoop(uint32_t index) {
+    currentJobSystem = this;
+    currentWorkerIndex = index;
+    int32_t worker = static_cast<int32_t>(index) - 1;
+    while (true) {
+        Job job;
+        if (take(job, worker, false)) {
+            run(job);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        sleep.wait(lock, [&]() { return stopping || queued.load(std::memory_order_acquire) > 0; });
+        //Finish what was queued before stopping, someone may still be waiting on it.
+        if (stopping && queued.load(std::memory_order_acquire) == 0) {
+            return;
+        }
+    }
+}
+
+bool JobSystem::take(Job& job, int32_t worker, bool allowMainThread) {
+    if (allowMainThread && mainThreadQueued.load(std::memory_order_acquire) > 0 && takeFrom(sharedMutex, mainThreadJobs, job, false)) {
+        mainThreadQueued.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    if (queued.load(std::memory_order_acquire) == 0) {
+        return false;
+    }
+    bool taken = (worker >= 0 && takeFrom(workers[worker]->mutex, workers[worker]->jobs, job, true))
+        || takeFrom(sharedMutex, sharedJobs, job, false);
+    //Steal the oldest job from the others, starting after this worker so thieves spread out.
+    for (size_t i = 0; !taken && i < workers.size(); i++) {
+        size_t victim = (static_cast<size_t>(worker + 1) + i) % workers.size();
+        if (static_cast<int32_t>(victim) != worker) {
+            taken = takeFrom(workers[victim]->mutex, workers[victim]->jobs, job, false);
+        }
+    }
+    if (taken) {
+        queued.fetch_sub(1, std::memory_order_relaxed);
+    }
+    return taken;
+}
+
+bool JobSystem::takeFrom(std::mutex& mutex, std::deque<Job>& jobs, Job& job, bool newest) {
+    std::lock_guard<std::mutex> guard(mutex);
+    if (jobs.empty()) {
+        return false;
+    }
+    if (newest) {
+        job = std::move(jobs.back());
+        jobs.pop_back();
+    } else {
+        job = std::move(jobs.front());
+        jobs.pop_front();
+    }
+    return true;
+}
+
+void JobSystem::run(Job& job) {
+    JobCounter* counter = job.counter;
+    try {
+        job.function();
+    } catch (...) {
+        if (!counter) {
+            std::lock_guard<std::mutex> guard(sharedMutex);
+            if (!uncountedError) {
+                uncountedError = std::current_exception();
+            }
+        } else if (!counter->failed.exchange(true, std::memory_order_acq_rel)) {
+            counter->error = std::current_exception();
+        }
+    }
+    //Drop captures before anyone waiting on the counter can return.
+    job.function = nullptr;
+    //The counter may be gone as soon as it reaches zero, so only the pool is touched after that.
+    if (counter && counter->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        notify(true);
+    }
+}
+
+void JobSystem::notify(bool all) {
+    {
+        std::lock_guard<std::mutex> guard(sleepMutex);
+    }
+    if (all) {
+        sleep.notify_all();
+    } else {
+        sleep.notify_one();
+    }
+}
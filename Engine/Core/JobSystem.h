@@ -0,0 +1,142 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Core/Export.h"
+
+/// Counts the unfinished jobs submitted against it. JobSystem::Wait() returns once it reaches zero and
+/// rethrows the first exception any of those jobs threw. Must outlive the jobs counted on it.
+class GP_EXPORT JobCounter {
+public:
+    JobCounter() = default;
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool IsDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+    std::atomic<uint32_t> pending{ 0 };
+    std::atomic<bool> failed{ false };
+    std::exception_ptr error;
+};
+
+/// The engine's worker threads, shared by everything that wants to run work in parallel: the
+/// SystemScheduler, place file prefetching, and systems fanning their own work out with ParallelFor().
+/// Each worker keeps its own deque of jobs; it takes the newest job from its own deque and, when that is
+/// empty, steals the oldest from another worker's, so work submitted from inside a job stays on the core
+/// that made it while idle cores still find something to do. Jobs submitted from outside the workers wait
+/// on a shared queue any worker takes from.
+///
+/// Jobs submitted with MainThread affinity only ever run on the thread that created the job system, the
+/// simulation thread, from Wait() or RunMainThreadJobs(). A thread blocked in Wait() runs queued jobs
+/// rather than sleeping, so waiting from inside a job cannot deadlock the pool.
+class GP_EXPORT JobSystem {
+public:
+    enum class Affinity : uint8_t {
+        Any,
+        MainThread
+    };
+
+    /// The calling thread becomes the main thread.
+    explicit JobSystem(size_t workerCount = defaultWorkerCount());
+    ~JobSystem();
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /// Queues job to run once. If counter is given, it is incremented now and decremented when the job ends.
+    /// A job without a counter must not throw; if it does, the exception is rethrown by RunMainThreadJobs().
+    void Submit(std::function<void()> job, JobCounter* counter = nullptr, Affinity affinity = Affinity::Any);
+
+    /// Runs queued jobs on the calling thread until counter reaches zero, then rethrows the first exception
+    /// a job counted on it threw. Main-thread jobs only run here when called from the main thread.
+    void Wait(JobCounter& counter);
+
+    /// Runs every job queued for the main thread. Main thread only. Engine::Update() calls this each frame.
+    void RunMainThreadJobs();
+
+    /// Calls body(first, last) for consecutive ranges of at most grainSize indices covering [begin, end),
+    /// spread over the workers and the calling thread, and returns when all are done. The calling thread
+    /// runs ranges too, so this is safe to call from inside a job.
+    template<typename Body>
+    void ParallelFor(size_t begin, size_t end, size_t grainSize, Body&& body) {
+        grainSize = std::max<size_t>(grainSize, 1);
+        if (end <= begin) {
+            return;
+        }
+        if (end - begin <= grainSize || workers.empty()) {
+            body(begin, end);
+            return;
+        }
+        JobCounter counter;
+        //Keep the first range for this thread, it would only wait otherwise.
+        for (size_t first = begin + grainSize; first < end; first += grainSize) {
+            size_t last = std::min(first + grainSize, end);
+            Submit([&body, first, last]() { body(first, last); }, &counter);
+        }
+        std::exception_ptr error;
+        try {
+            body(begin, std::min(begin + grainSize, end));
+        } catch (...) {
+            error = std::current_exception();
+        }
+        //The other ranges still reference body, so they have to finish before an exception leaves.
+        Wait(counter);
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    bool IsMainThread() const { return std::this_thread::get_id() == mainThreadId; }
+    /// 0 on the main thread and any other thread outside the pool, 1 and up on the workers.
+    uint32_t GetCurrentThreadIndex() const;
+    size_t GetWorkerCount() const { return workers.size(); }
+
+    /// One worker per core besides the main thread, and at least one, so work handed to the pool
+    /// always progresses without the main thread's help.
+    static size_t defaultWorkerCount();
+
+private:
+    struct Job {
+        std::function<void()> function;
+        JobCounter* counter;
+    };
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+        std::thread thread;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::thread::id mainThreadId;
+
+    std::mutex sharedMutex;
+    /// Jobs submitted from outside the pool.
+    std::deque<Job> sharedJobs;
+    std::deque<Job> mainThreadJobs;
+    std::exception_ptr uncountedError;
+
+    /// Jobs queued but not yet taken, other than main-thread ones. Sleeping threads wait for it to change.
+    std::atomic<size_t> queued{ 0 };
+    std::atomic<size_t> mainThreadQueued{ 0 };
+    std::mutex sleepMutex;
+    std::condition_variable sleep;
+    bool stopping = false;
+
+    void workerLoop(uint32_t index);
+    /// Takes a job for the calling thread: main-thread jobs first if allowed, then its own deque, then the
+    /// shared queue, then other workers' deques.
+    bool take(Job& job, int32_t worker, bool allowMainThread);
+    bool takeFrom(std::mutex& mutex, std::deque<Job>& jobs, Job& job, bool newest);
+    void run(Job& job);
+    void notify(bool all);
+};
@@ -38,7 +38,7 @@ public:
 
     void Clear();
 
-    void Update(double deltaTime);
+    void Update(double deltaTime) override;
 
     MulticastEvent<std::string, Level> MessageLogged;
 private:
@@ -57,16 +57,21 @@ private:
 //REFLECTION_END()
 namespace Reflection { 
  
-	inline void register_LogSystem() { 
-		Reflection::GetRegistry().classes["LogSystem"] = &Reflection::reflected_LogSystem; 
-		Reflection::GetRegistry().classesById[2491798829761274318] = &Reflection::reflected_LogSystem; 
- 
-	} 
 	inline ::Instance* instantiate_LogSystem(Engine* engine) { 
 		return (::Instance*)new LogSystem(engine); 
 	} 
 	inline ::std::shared_ptr<::Instance> instantiateShared_LogSystem(Engine* engine) { 
 		return ::std::static_pointer_cast<::Instance>(::std::make_shared<LogSystem>(engine)); 
 	} 
+	inline constexpr uint64_t publicBases_LogSystem[] = { 15348723867526545374ULL }; 
+	inline constinit Class reflected_LogSystem = { 
+		.className = "LogSystem", 
+		.id = 2491798829761274318ULL, 
+		.constructor = &instantiate_LogSystem, 
+		.sharedConstructor = &instantiateShared_LogSystem, 
+		.publicBaseClasses = publicBases_LogSystem 
+	}; 
+	inline void register_LogSystem() { 
+		Reflection::GetRegistry().Register(&Reflection::reflected_LogSystem); 
+	} 
 } 
-
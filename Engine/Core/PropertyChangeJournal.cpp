@@ -0,0 +1,133 @@
+#include "Core/PropertyChangeJournal.h"
+#include "Instance/Instance.h"
+#include <algorithm>
+#include <bit>
+
+PropertyChangeJournal::Cursor::Cursor(Cursor&& other) noexcept : journal(other.journal), slot(other.slot) {
+    other.journal = nullptr;
+}
+
+PropertyChangeJournal::Cursor& PropertyChangeJournal::Cursor::operator=(Cursor&& other) noexcept {
+    if (this != &other) {
+        if (journal) {
+            journal->releaseCursor(slot);
+        }
+        journal = other.journal;
+        slot = other.slot;
+        other.journal = nullptr;
+    }
+    return *this;
+}
+
+PropertyChangeJournal::Cursor::~Cursor() {
+    if (journal) {
+        journal->releaseCursor(slot);
+    }
+}
+
+PropertyChangeJournal::~PropertyChangeJournal() {
+    Clear();
+}
+
+void PropertyChangeJournal::Record(Instance* instance) {
+    InstanceRef<> ref(instance);
+    if (!ref) {
+        //Destroyed already; its changes have nowhere to go.
+        return;
+    }
+    std::lock_guard<std::mutex> guard(recordMutex);
+    entries.push_back(ref);
+}
+
+void PropertyChangeJournal::Forget(Instance* instance) {
+    instance->dirtyProps = 0;
+}
+
+PropertyChangeJournal::Cursor PropertyChangeJournal::MakeCursor() {
+    uint32_t slot;
+    if (!freeCursors.empty()) {
+        slot = freeCursors.back();
+        freeCursors.pop_back();
+        cursorEpochs[slot] = epoch;
+    } else {
+        slot = static_cast<uint32_t>(cursorEpochs.size());
+        cursorEpochs.push_back(epoch);
+    }
+    return Cursor(this, slot);
+}
+
+void PropertyChangeJournal::releaseCursor(uint32_t slot) {
+    cursorEpochs[slot] = FreeCursor;
+    freeCursors.push_back(slot);
+    trimHistory();
+}
+
+uint64_t PropertyChangeJournal::oldestCursorEpoch() const {
+    uint64_t oldest = FreeCursor;
+    for (uint64_t cursorEpoch : cursorEpochs) {
+        oldest = std::min(oldest, cursorEpoch);
+    }
+    return oldest == FreeCursor ? epoch : oldest;
+}
+
+void PropertyChangeJournal::Flush() {
+    //Nobody could ever collect this frame's changes without a cursor.
+    bool keepHistory = freeCursors.size() != cursorEpochs.size();
+
+    //Changes raised by listeners while a round is delivered go into a fresh round.
+    for (size_t round = 0; round < MaxFlushRounds && !entries.empty(); round++) {
+        delivering.swap(entries);
+
+        for (size_t i = 0; i < delivering.size(); i++) {
+            Instance* instance = delivering[i].Get();
+            if (!instance) {
+                continue;
+            }
+            //Cleared before delivery, so a listener changing the instance again queues it for the next round.
+            uint64_t dirtyProps = instance->dirtyProps;
+            instance->dirtyProps = 0;
+            if (keepHistory) {
+                history.push_back({ delivering[i], dirtyProps, epoch });
+            }
+
+            Reflection::Class* cls = instance->GetClass();
+            const Reflection::PropertyTable& table = cls->propertyTable;
+            uint64_t pending = dirtyProps & ~cls->immediateProps;
+            while (pending != 0) {
+                uint32_t index = static_cast<uint32_t>(std::countr_zero(pending));
+                pending &= pending - 1;
+                if (index >= table.properties.size()) {
+                    break;
+                }
+                instance->firePropertyChanged(table.properties[index]->id);
+                if (!delivering[i]) {
+                    //A listener destroyed the instance.
+                    break;
+                }
+            }
+        }
+        delivering.clear();
+    }
+    epoch++;
+    trimHistory();
+}
+
+void PropertyChangeJournal::Clear() {
+    for (InstanceRef<>& entry : entries) {
+        if (Instance* instance = entry.Get()) {
+            instance->dirtyProps = 0;
+        }
+    }
+    entries.clear();
+    history.clear();
+}
+
+void PropertyChangeJournal::trimHistory() {
+    uint64_t keepFrom = oldestCursorEpoch();
+    if (epoch > HistoryEpochs) {
+        keepFrom = std::max(keepFrom, epoch - HistoryEpochs);
+    }
+    while (!history.empty() && history.front().epoch < keepFrom) {
+        history.pop_front();
+    }
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <vector>
+#include "Core/Export.h"
+#include "Instance/InstanceRef.h"
+
+class Instance;
+
+/// Collects the property changes raised during a frame and delivers each (instance, property) pair once,
+/// when the engine flushes at the end of Engine::Update. Setting the same property many times in a frame
+/// costs one PropertyChanged/Changed dispatch, and listeners observe the final value.
+/// Changes are tracked per instance as a bitset over its class's dense property indices (Instance::dirtyProps),
+/// so recording a change is a single bit-or; the journal only keeps a list of instances with any bit set.
+/// Properties flagged PropFlags::Immediate fire synchronously instead, but are still marked dirty.
+///
+/// Every Flush() closes an epoch. Consumers such as replication, saving or undo can hold a Cursor and ask what
+/// changed since they last looked, instead of connecting a listener to every instance. Dirty bitsets are kept
+/// only as far back as the oldest live cursor, and at most HistoryEpochs; with no cursors nothing is kept.
+///
+/// Queue and history entries are weak InstanceRefs, so a destroyed instance simply stops resolving and
+/// nothing has to be searched out when it goes away.
+/// Record() may be called from systems the SystemScheduler runs on worker threads; everything else belongs to
+/// the simulation thread.
+class GP_EXPORT PropertyChangeJournal {
+public:
+    /// Rounds of changes raised by listeners during a flush that are still delivered in the same flush.
+    /// Anything left after that waits for the next frame, so listeners feeding each other cannot stall it.
+    static constexpr size_t MaxFlushRounds = 8;
+    /// Epochs of dirty bitsets kept for Collect(). At one flush per frame this is about two seconds.
+    static constexpr uint64_t HistoryEpochs = 128;
+
+    /// Position in the change history, held by a consumer between calls to Collect(). Made by MakeCursor(); history
+    /// older than the oldest live cursor is dropped. Must not outlive its journal.
+    class GP_EXPORT Cursor {
+    public:
+        Cursor() = default;
+        Cursor(Cursor&& other) noexcept;
+        Cursor& operator=(Cursor&& other) noexcept;
+        ~Cursor();
+
+        bool IsValid() const { return journal != nullptr; }
+
+    private:
+        friend class PropertyChangeJournal;
+        Cursor(PropertyChangeJournal* _journal, uint32_t _slot) : journal(_journal), slot(_slot) {}
+
+        PropertyChangeJournal* journal = nullptr;
+        uint32_t slot = 0;
+    };
+
+    PropertyChangeJournal() = default;
+    ~PropertyChangeJournal();
+    PropertyChangeJournal(const PropertyChangeJournal&) = delete;
+    PropertyChangeJournal& operator=(const PropertyChangeJournal&) = delete;
+
+    /// Queues an instance whose dirtyProps just went from empty to non-empty. Called by Instance::markPropertyDirty.
+    void Record(Instance* instance);
+
+    /// Drops the pending changes of an instance that is going away. O(1): its queue and history entries stop
+    /// resolving once its InstanceRef slot is released.
+    void Forget(Instance* instance);
+
+    /// Delivers all queued changes, instances in the order they first changed and each instance's properties
+    /// in index order, then closes the current epoch.
+    void Flush();
+
+    /// Drops everything queued without delivering it, along with the history.
+    void Clear();
+
+    size_t GetPendingCount() const { return entries.size(); }
+
+    /// Number of Flush() calls so far. Changes recorded now belong to this epoch.
+    uint64_t GetEpoch() const { return epoch; }
+    /// A cursor that Collect() will report changes to from the next flush on.
+    Cursor MakeCursor();
+
+    /// Calls visitor(Instance*, uint64_t dirtyProps) for every change flushed since cursor, where bit i of dirtyProps
+    /// stands for instance->GetClass()->propertyTable.properties[i], then moves cursor to the current epoch.
+    /// An instance that changed in several epochs is reported once per epoch; destroyed instances are skipped.
+    /// Returns false, without visiting anything, if cursor is older than the retained history; the consumer then
+    /// has to resynchronize from scratch.
+    template<typename Visitor>
+    bool Collect(Cursor& cursor, Visitor&& visitor) {
+        uint64_t& cursorEpoch = cursorEpochs[cursor.slot];
+        uint64_t since = cursorEpoch;
+        cursorEpoch = epoch;
+        if (since + HistoryEpochs < epoch) {
+            return false;
+        }
+        //Entries are appended in epoch order, so the first one to report can be binary searched.
+        size_t lo = 0;
+        size_t hi = history.size();
+        while (lo < hi) {
+            size_t mid = (lo + hi) / 2;
+            if (history[mid].epoch < since) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        for (size_t i = lo; i < history.size(); i++) {
+            const HistoryEntry& entry = history[i];
+            if (Instance* instance = entry.instance.Get()) {
+                visitor(instance, entry.dirtyProps);
+            }
+        }
+        return true;
+    }
+
+private:
+    struct HistoryEntry {
+        InstanceRef<> instance;
+        uint64_t dirtyProps;
+        uint64_t epoch;
+    };
+    static constexpr uint64_t FreeCursor = UINT64_MAX;
+
+    /// Instances with dirty properties, in the order they first changed.
+    std::vector<InstanceRef<>> entries;
+    /// The round currently being delivered by Flush().
+    std::vector<InstanceRef<>> delivering;
+    std::deque<HistoryEntry> history;
+    uint64_t epoch = 0;
+    /// Epoch each live cursor has collected up to, FreeCursor for released ones.
+    std::vector<uint64_t> cursorEpochs;
+    std::vector<uint32_t> freeCursors;
+    /// Serializes Record() between systems updating in parallel. Only ever taken once per instance per frame.
+    std::mutex recordMutex;
+
+    void releaseCursor(uint32_t slot);
+    /// Epoch of the oldest live cursor, or the current epoch if there are none.
+    uint64_t oldestCursorEpoch() const;
+    void trimHistory();
+};
@@ -0,0 +1,232 @@
+#include "Core/SystemScheduler.h"
+#include "Instance/System.h"
+#include "Instance/Reflection.h"
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <stdexcept>
+#include <string>
+
+void SystemInitOrder::Add(System* system) {
+    if (systemIndices.emplace(system, systems.size()).second) {
+        systems.push_back(system);
+    }
+}
+void SystemInitOrder::Before(System* system, std::string_view beforeSystemName) {
+    Add(system);
+    rules.push_back({ system, beforeSystemName, SystemRelation::Before });
+}
+void SystemInitOrder::After(System* system, std::string_view afterSystemName) {
+    Add(system);
+    rules.push_back({ system, afterSystemName, SystemRelation::After });
+}
+
+void SystemInitOrder::Reads(System* system, const Reflection::Class& cls) {
+    Add(system);
+    accesses.push_back({ system, &cls, {}, false });
+}
+void SystemInitOrder::Writes(System* system, const Reflection::Class& cls) {
+    Add(system);
+    accesses.push_back({ system, &cls, {}, true });
+}
+void SystemInitOrder::Reads(System* system, std::string_view resource) {
+    Add(system);
+    accesses.push_back({ system, nullptr, resource, false });
+}
+void SystemInitOrder::Writes(System* system, std::string_view resource) {
+    Add(system);
+    accesses.push_back({ system, nullptr, resource, true });
+}
+
+SystemScheduler::SystemScheduler(JobSystem& jobs) : jobs(jobs) {}
+
+void SystemScheduler::Build(const SystemInitOrder& initOrder) {
+    const std::vector<System*>& systems = initOrder.systems;
+    size_t count = systems.size();
+
+    std::unordered_map<std::string_view, size_t> indicesByName;
+    for (size_t i = 0; i < count; i++) {
+        indicesByName[systems[i]->GetClass()->className] = i;
+    }
+
+    //Before/After rules, by index in initOrder. Rules naming a system that does not exist are ignored.
+    std::vector<std::vector<size_t>> successors(count);
+    std::vector<uint32_t> predecessorCounts(count, 0);
+    auto addEdge = [&](size_t from, size_t to) {
+        if (std::find(successors[from].begin(), successors[from].end(), to) == successors[from].end()) {
+            successors[from].push_back(to);
+            predecessorCounts[to]++;
+        }
+    };
+    for (const SystemInitOrder::Rule& rule : initOrder.rules) {
+        auto it = indicesByName.find(rule.relativeToName);
+        if (it == indicesByName.end()) {
+            continue;
+        }
+        size_t system = initOrder.systemIndices.at(rule.system);
+        if (rule.relation == SystemInitOrder::SystemRelation::Before) {
+            addEdge(system, it->second);
+        } else {
+            addEdge(it->second, system);
+        }
+    }
+
+    //Kahn's algorithm, taking the earliest added system whenever there is a choice so the order is stable.
+    std::vector<size_t> sorted;
+    std::vector<uint32_t> remaining = predecessorCounts;
+    std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> ready;
+    for (size_t i = 0; i < count; i++) {
+        if (remaining[i] == 0) {
+            ready.push(i);
+        }
+    }
+    while (!ready.empty()) {
+        size_t next = ready.top();
+        ready.pop();
+        sorted.push_back(next);
+        for (size_t successor : successors[next]) {
+            if (--remaining[successor] == 0) {
+                ready.push(successor);
+            }
+        }
+    }
+
+    if (sorted.size() != count) {
+        //Everything left is on a cycle or behind one, so each has a left-over predecessor. Walk those
+        //backwards until a system repeats.
+        std::vector<std::vector<size_t>> predecessors(count);
+        for (size_t from = 0; from < count; from++) {
+            for (size_t to : successors[from]) {
+                if (remaining[from] > 0 && remaining[to] > 0) {
+                    predecessors[to].push_back(from);
+                }
+            }
+        }
+        std::vector<size_t> path;
+        std::vector<bool> onPath(count, false);
+        size_t current = 0;
+        while (remaining[current] == 0) {
+            current++;
+        }
+        while (!onPath[current]) {
+            onPath[current] = true;
+            path.push_back(current);
+            current = predecessors[current].front();
+        }
+        std::string cycle = std::string(systems[current]->GetClass()->className);
+        for (size_t i = path.size(); path[--i] != current;) {
+            cycle += " -> " + std::string(systems[path[i]]->GetClass()->className);
+        }
+        cycle += " -> " + std::string(systems[current]->GetClass()->className);
+        throw std::runtime_error("System update order has a cycle: " + cycle);
+    }
+
+    //Nodes are numbered in sorted order from here on.
+    std::vector<uint32_t> nodeOf(count);
+    for (size_t i = 0; i < count; i++) {
+        nodeOf[sorted[i]] = static_cast<uint32_t>(i);
+    }
+    std::vector<std::vector<const SystemInitOrder::Access*>> accesses(count);
+    for (const SystemInitOrder::Access& access : initOrder.accesses) {
+        accesses[nodeOf[initOrder.systemIndices.at(access.system)]].push_back(&access);
+    }
+
+    order.clear();
+    nodes.clear();
+    nodes.resize(count);
+    for (size_t i = 0; i < count; i++) {
+        order.push_back(systems[sorted[i]]);
+        nodes[i].system = systems[sorted[i]];
+        nodes[i].mainThread = accesses[i].empty();
+    }
+
+    auto overlaps = [](const SystemInitOrder::Access* a, const SystemInitOrder::Access* b) {
+        if (!a->write && !b->write) {
+            return false;
+        }
+        if (a->cls && b->cls) {
+            return a->cls->IsA(b->cls) || b->cls->IsA(a->cls);
+        }
+        return !a->cls && !b->cls && a->resource == b->resource;
+    };
+    auto conflicts = [&](size_t a, size_t b) {
+        //A system that declared nothing may touch anything.
+        if (nodes[a].mainThread || nodes[b].mainThread) {
+            return true;
+        }
+        for (const SystemInitOrder::Access* accessA : accesses[a]) {
+            for (const SystemInitOrder::Access* accessB : accesses[b]) {
+                if (overlaps(accessA, accessB)) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    };
+
+    for (size_t from = 0; from < count; from++) {
+        for (size_t to : successors[sorted[from]]) {
+            nodes[from].successors.push_back(nodeOf[to]);
+            nodes[nodeOf[to]].predecessorCount++;
+        }
+    }
+    //Conflicting pairs run in sorted order, which already agrees with every rule, so no cycle can appear.
+    for (size_t from = 0; from < count; from++) {
+        for (size_t to = from + 1; to < count; to++) {
+            std::vector<uint32_t>& edges = nodes[from].successors;
+            if (conflicts(from, to) && std::find(edges.begin(), edges.end(), to) == edges.end()) {
+                edges.push_back(static_cast<uint32_t>(to));
+                nodes[to].predecessorCount++;
+            }
+        }
+    }
+
+    timings.assign(count, SystemTiming());
+    for (size_t i = 0; i < count; i++) {
+        timings[i].system = nodes[i].system;
+    }
+    remainingPredecessors = std::make_unique<std::atomic<uint32_t>[]>(count);
+}
+
+void SystemScheduler::Run(double frameDeltaTime) {
+    deltaTime = frameDeltaTime;
+    frameStart = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < nodes.size(); i++) {
+        remainingPredecessors[i].store(nodes[i].predecessorCount, std::memory_order_relaxed);
+        timings[i].start = 0.0;
+        timings[i].duration = 0.0;
+    }
+
+    JobCounter frame;
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (nodes[i].predecessorCount == 0) {
+            submit(static_cast<uint32_t>(i), frame);
+        }
+    }
+    //Runs the main-thread systems as they become ready, and helps with the rest.
+    jobs.Wait(frame);
+}
+
+void SystemScheduler::submit(uint32_t node, JobCounter& frame) {
+    jobs.Submit([this, node, &frame]() { runNode(node, frame); }, &frame,
+        nodes[node].mainThread ? JobSystem::Affinity::MainThread : JobSystem::Affinity::Any);
+}
+
+void SystemScheduler::runNode(uint32_t node, JobCounter& frame) {
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    //If this throws, the job system hands the exception to Run() and nothing after this system is submitted.
+    nodes[node].system->Update(deltaTime);
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    SystemTiming& timing = timings[node];
+    timing.start = std::chrono::duration<double>(start - frameStart).count();
+    timing.duration = std::chrono::duration<double>(end - start).count();
+    timing.thread = jobs.GetCurrentThreadIndex();
+
+    //Successors are submitted before this job ends, so the frame counter cannot reach zero early.
+    for (uint32_t successor : nodes[node].successors) {
+        if (remainingPredecessors[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            submit(successor, frame);
+        }
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Core/Export.h"
+#include "Core/JobSystem.h"
+
+class System;
+
+namespace Reflection {
+    struct Class;
+}
+
+/// What systems declare about themselves from System::Register(): which systems they have to run before
+/// or after, and which data their Update() reads and writes. A system that declares any access promises
+/// to touch nothing else during Update(), and not to create, destroy or reparent instances, and may then
+/// run on a worker thread alongside systems it does not conflict with. Systems that declare no access run
+/// on the thread calling Engine::Update(), one at a time, as all systems used to.
+class GP_EXPORT SystemInitOrder {
+public:
+    void Before(System* system, std::string_view beforeSystemName);
+    void After(System* system, std::string_view afterSystemName);
+    void Add(System* system);
+
+    /// Instances of cls and its subclasses.
+    void Reads(System* system, const Reflection::Class& cls);
+    void Writes(System* system, const Reflection::Class& cls);
+    /// Data that is not an instance class, such as a TransformStore component. Matched by name.
+    void Reads(System* system, std::string_view resource);
+    void Writes(System* system, std::string_view resource);
+
+    template<typename T>
+    void Reads(System* system) {
+        Reads(system, T::StaticClass());
+    }
+    template<typename T>
+    void Writes(System* system) {
+        Writes(system, T::StaticClass());
+    }
+
+protected:
+    friend class SystemScheduler;
+    enum class SystemRelation {
+        Before,
+        After
+    };
+    struct Rule {
+        System* system;
+        std::string_view relativeToName;
+        SystemRelation relation;
+    };
+    struct Access {
+        System* system;
+        const Reflection::Class* cls;
+        std::string_view resource;
+        bool write;
+    };
+
+    std::vector<System*> systems;
+    std::unordered_map<System*, size_t> systemIndices;
+    std::vector<Rule> rules;
+    std::vector<Access> accesses;
+};
+
+/// Where one system's Update() ran during the last frame.
+struct SystemTiming {
+    System* system = nullptr;
+    /// Seconds from the start of SystemScheduler::Run().
+    double start = 0.0;
+    double duration = 0.0;
+    /// JobSystem::GetCurrentThreadIndex() of the thread it ran on, 0 for the main thread.
+    uint32_t thread = 0;
+};
+
+/// Runs System::Update() for every system each frame, as a DAG built once from a SystemInitOrder.
+/// Edges come from Before/After rules and from conflicting access: two systems where one writes what the
+/// other reads or writes are ordered as they appear in the resolved order. Systems with no path between
+/// them run concurrently as jobs on the engine's JobSystem, and the calling thread helps until the frame
+/// is done. Systems that declared no access are MainThread jobs.
+class GP_EXPORT SystemScheduler {
+public:
+    explicit SystemScheduler(JobSystem& jobs);
+    SystemScheduler(const SystemScheduler&) = delete;
+    SystemScheduler& operator=(const SystemScheduler&) = delete;
+
+    /// Resolves the order and builds the DAG. Throws std::runtime_error, naming the systems involved, if the
+    /// Before/After rules form a cycle.
+    void Build(const SystemInitOrder& initOrder);
+
+    /// Every system in an order that satisfies the Before/After rules, used for Initialize() and Shutdown().
+    std::span<System* const> GetOrder() const { return order; }
+
+    /// Updates every system once and returns when all are done. Main thread only. If an Update() throws,
+    /// the systems after it in the DAG are skipped and the first exception is rethrown here.
+    void Run(double deltaTime);
+
+    /// One entry per system, in GetOrder() order, for the last Run().
+    std::span<const SystemTiming> GetTimings() const { return timings; }
+
+private:
+    struct Node {
+        System* system;
+        std::vector<uint32_t> successors;
+        uint32_t predecessorCount = 0;
+        /// Declared no access, so it may touch anything and runs on the main thread.
+        bool mainThread = true;
+    };
+
+    JobSystem& jobs;
+    std::vector<System*> order;
+    std::vector<Node> nodes;
+    std::vector<SystemTiming> timings;
+
+    //Per frame.
+    std::unique_ptr<std::atomic<uint32_t>[]> remainingPredecessors;
+    double deltaTime = 0.0;
+    std::chrono::steady_clock::time_point frameStart;
+
+    void submit(uint32_t node, JobCounter& frame);
+    void runNode(uint32_t node, JobCounter& frame);
+};
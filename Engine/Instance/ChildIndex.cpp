@@ -0,0 +1,185 @@
+#include "Instance/ChildIndex.h"
+#include "Instance/Instance.h"
+
+namespace {
+	uint64_t hashName(std::string_view name) {
+		return Reflection::fnv1a64(name);
+	}
+}
+
+ChildIndex::ChildIndex(const std::vector<Instance*>& children) {
+	size_t capacity = 16;
+	while (capacity < children.size() * 2) {
+		capacity *= 2;
+	}
+	nameSlots.resize(capacity);
+
+	Reflection::Registry& registry = Reflection::GetRegistry();
+	classGeneration = registry.GetGeneration();
+	firstByClass.resize(registry.classesByIndex.size(), nullptr);
+
+	for (Instance* child : children) {
+		OnChildAdded(child);
+	}
+}
+
+Instance* ChildIndex::FindByName(std::string_view name, const std::vector<Instance*>& children) const {
+	uint64_t hash = hashName(name);
+	const NameSlot& slot = nameSlots[findNameSlot(hash)];
+	if (!slot.child) {
+		return nullptr;
+	}
+	if (slot.child->Name == name) {
+		return slot.child;
+	}
+	//Two different names share a hash; fall back to a scan for this (very unlikely) case.
+	for (Instance* child : children) {
+		if (child->Name == name) {
+			return child;
+		}
+	}
+	return nullptr;
+}
+
+bool ChildIndex::HasClassIndex() const {
+	return Reflection::GetRegistry().IsFinalized() && classGeneration == Reflection::GetRegistry().GetGeneration();
+}
+
+Instance* ChildIndex::FindByClass(const Reflection::Class* cls) const {
+	if (!cls || cls->index >= firstByClass.size()) {
+		return nullptr;
+	}
+	return firstByClass[cls->index];
+}
+
+void ChildIndex::OnChildAdded(Instance* child) {
+	child->indexedNameHash = hashName(child->Name);
+	size_t slot = findNameSlot(child->indexedNameHash);
+	if (!nameSlots[slot].child) {
+		setName(child->indexedNameHash, child);
+	}
+
+	const Reflection::Class* cls = child->GetClass();
+	if (cls->index < firstByClass.size() && !firstByClass[cls->index]) {
+		firstByClass[cls->index] = child;
+	}
+}
+
+void ChildIndex::OnChildRemoved(Instance* child, const std::vector<Instance*>& children) {
+	if (nameSlots[findNameSlot(child->indexedNameHash)].child == child) {
+		refreshName(child->indexedNameHash, children);
+	}
+
+	const Reflection::Class* cls = child->GetClass();
+	if (cls->index < firstByClass.size() && firstByClass[cls->index] == child) {
+		refreshClass(cls, children);
+	}
+}
+
+void ChildIndex::OnChildRenamed(Instance* child, const std::vector<Instance*>& children) {
+	uint64_t oldHash = child->indexedNameHash;
+	uint64_t newHash = hashName(child->Name);
+	if (oldHash == newHash) {
+		return;
+	}
+	child->indexedNameHash = newHash;
+
+	if (nameSlots[findNameSlot(oldHash)].child == child) {
+		refreshName(oldHash, children);
+	}
+
+	Instance* existing = nameSlots[findNameSlot(newHash)].child;
+	if (!existing) {
+		setName(newHash, child);
+		return;
+	}
+	//Keep whichever of the two comes first in the Children order.
+	for (Instance* sibling : children) {
+		if (sibling == existing) {
+			return;
+		}
+		if (sibling == child) {
+			setName(newHash, child);
+			return;
+		}
+	}
+}
+
+size_t ChildIndex::findNameSlot(uint64_t hash) const {
+	size_t mask = nameSlots.size() - 1;
+	size_t i = static_cast<size_t>(hash) & mask;
+	while (nameSlots[i].child && nameSlots[i].hash != hash) {
+		i = (i + 1) & mask;
+	}
+	return i;
+}
+
+void ChildIndex::setName(uint64_t hash, Instance* child) {
+	size_t slot = findNameSlot(hash);
+	if (!nameSlots[slot].child) {
+		if ((nameCount + 1) * 2 > nameSlots.size()) {
+			growNames();
+			slot = findNameSlot(hash);
+		}
+		nameCount++;
+	}
+	nameSlots[slot] = { hash, child };
+}
+
+void ChildIndex::eraseName(uint64_t hash) {
+	size_t mask = nameSlots.size() - 1;
+	size_t i = findNameSlot(hash);
+	if (!nameSlots[i].child) {
+		return;
+	}
+	nameCount--;
+
+	//Backward shift deletion, so probe chains stay intact without tombstones.
+	size_t j = i;
+	while (true) {
+		j = (j + 1) & mask;
+		if (!nameSlots[j].child) {
+			break;
+		}
+		size_t home = static_cast<size_t>(nameSlots[j].hash) & mask;
+		bool homeInRange = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+		if (!homeInRange) {
+			nameSlots[i] = nameSlots[j];
+			i = j;
+		}
+	}
+	nameSlots[i] = NameSlot();
+}
+
+void ChildIndex::growNames() {
+	std::vector<NameSlot> oldSlots;
+	oldSlots.swap(nameSlots);
+	nameSlots.resize(oldSlots.size() * 2);
+	nameCount = 0;
+	for (const NameSlot& slot : oldSlots) {
+		if (slot.child) {
+			nameSlots[findNameSlot(slot.hash)] = slot;
+			nameCount++;
+		}
+	}
+}
+
+void ChildIndex::refreshName(uint64_t hash, const std::vector<Instance*>& children) {
+	for (Instance* child : children) {
+		if (child->indexedNameHash == hash) {
+			setName(hash, child);
+			return;
+		}
+	}
+	eraseName(hash);
+}
+
+void ChildIndex::refreshClass(const Reflection::Class* cls, const std::vector<Instance*>& children) {
+	for (Instance* child : children) {
+		if (child->GetClass() == cls) {
+			firstByClass[cls->index] = child;
+			return;
+		}
+	}
+	firstByClass[cls->index] = nullptr;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+class Instance;
+
+namespace Reflection {
+	struct Class;
+}
+
+/// Lookup tables over an instance's Children, built lazily once the child count passes
+/// ChildIndex::Threshold. Maps a name hash to the first child with that name and a dense
+/// class index to the first child of exactly that class, matching the linear scan order.
+class ChildIndex {
+public:
+	static constexpr size_t Threshold = 32;
+
+	explicit ChildIndex(const std::vector<Instance*>& children);
+
+	/// Returns the first child with the given name, or nullptr.
+	Instance* FindByName(std::string_view name, const std::vector<Instance*>& children) const;
+
+	/// False if the class hierarchy was (re)finalized after this index was built, in which case
+	/// FindByClass cannot be trusted and callers should scan instead.
+	bool HasClassIndex() const;
+	/// Returns the first child whose class is exactly cls, or nullptr.
+	Instance* FindByClass(const Reflection::Class* cls) const;
+
+	/// Called after child has been appended to children.
+	void OnChildAdded(Instance* child);
+	/// Called after child has been erased from children.
+	void OnChildRemoved(Instance* child, const std::vector<Instance*>& children);
+	/// Called after child's Name has changed.
+	void OnChildRenamed(Instance* child, const std::vector<Instance*>& children);
+
+private:
+	struct NameSlot {
+		uint64_t hash = 0;
+		Instance* child = nullptr;
+	};
+
+	std::vector<NameSlot> nameSlots;
+	size_t nameCount = 0;
+	std::vector<Instance*> firstByClass;
+	uint32_t classGeneration = 0;
+
+	size_t findNameSlot(uint64_t hash) const;
+	void setName(uint64_t hash, Instance* child);
+	void eraseName(uint64_t hash);
+	void growNames();
+
+	void refreshName(uint64_t hash, const std::vector<Instance*>& children);
+	void refreshClass(const Reflection::Class* cls, const std::vector<Instance*>& children);
+};
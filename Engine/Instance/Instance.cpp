@@ -1,17 +1,168 @@
 #include "Instance/Instance.h"
+#include "Core/Engine.h"
+#include "Instance/ObjectInstance.h"
+#include "Serialization/PlaceFile.h"
+
+#include <algorithm>
+#include <future>
+#include <stdexcept>
 
 Instance::Instance(Engine* _engine)
-	: engine(_engine) {
-	Name = ClassName();
-	Id = EngineUUID();
+	: engine(_engine), refSlot(GetInstanceSlots().Acquire(this)) {
+	if (isTracked()) {
+		engine->GetInstanceIndex().Insert(Id, this);
+		engine->GetInstanceRegistry().Track(this);
+	}
+}
+
+Instance::~Instance() {
+	if (!destroyed) {
+		retire();
+	}
+}
+
+void Instance::retire() {
+	if (isTracked()) {
+		engine->GetPropertyChangeJournal().Forget(this);
+		engine->GetInstanceIndex().Erase(Id, this);
+		engine->GetInstanceRegistry().Untrack(this);
+	}
+	GetInstanceSlots().Release(refSlot);
+	refSlot = InstanceSlotTable::NoSlot;
+}
+
+void Instance::Destroy() {
+	if (destroyed) {
+		return;
+	}
+	if (static_cast<Instance*>(engine) == this) {
+		throw std::runtime_error("Cannot destroy the engine");
+	}
+	//Ancestors hear about the whole subtree leaving, the usual way.
+	SetParent(nullptr);
+
+	//Children of unloaded stubs were never created, so they are not walked (or loaded) here.
+	std::vector<Instance*> dead;
+	dead.push_back(this);
+	for (size_t i = 0; i < dead.size(); i++) {
+		dead.insert(dead.end(), dead[i]->Children.begin(), dead[i]->Children.end());
+	}
+	for (Instance* instance : dead) {
+		instance->destroyed = true;
+		instance->retire();
+		instance->disconnectEvents();
+		//A destroyed stub must not stream its descendants in before it is freed.
+		instance->unloadedSubtree.reset();
+	}
+
+	if (isTracked()) {
+		engine->QueueDestroyed(dead);
+	} else {
+		//Children first, see Engine::releaseDestroyed().
+		for (auto it = dead.rbegin(); it != dead.rend(); ++it) {
+			freeInstance(*it);
+		}
+	}
+}
+
+void Instance::freeInstance(Instance* instance) {
+	if (instance->pooled) {
+		instance->GetClass()->Destroy(instance);
+	} else {
+		delete instance;
+	}
+}
+
+void Instance::disconnectEvents() {
+	PropertyChanged.DisconnectAll();
+	LuaPropertyChanged.DisconnectAll();
+	ChildAdded.DisconnectAll();
+	ChildRemoved.DisconnectAll();
+	DescendantAdded.DisconnectAll();
+	DescendantRemoved.DisconnectAll();
+	DescendantsAdded.DisconnectAll();
+	DescendantsRemoved.DisconnectAll();
+	for (auto& [name, event] : luaPropChangeEvents) {
+		event.DisconnectAll();
+	}
+}
 
+bool Instance::isTracked() const {
+	//The engine is an instance too, but it cannot reach its own index or registry until its members are constructed.
+	return engine && static_cast<const Instance*>(engine) != this;
+}
+
+void Instance::AssignId(const EngineUUID& id) {
+	if (isTracked()) {
+		engine->GetInstanceIndex().Erase(Id, this);
+	}
+	Id = id;
+	if (isTracked()) {
+		engine->GetInstanceIndex().Insert(Id, this);
+	}
 }
 
 std::string Instance::GetPath(Instance* RelativeTo) {
-	if (Parent && RelativeTo != this) {
-		return Parent->GetPath() + "." + Name;
+	if (RelativeTo == this) {
+		return Name;
+	}
+	const std::string& path = fullPath();
+	if (RelativeTo && IsDescendantOf(RelativeTo)) {
+		return path.substr(RelativeTo->fullPath().size() + 1);
+	}
+	return path;
+}
+
+const std::string& Instance::fullPath() {
+	if (pathCached) {
+		return cachedPath;
+	}
+	//Find the nearest ancestor with a cached path, then build downwards from it.
+	std::vector<Instance*>& stack = traversalStack();
+	TraversalScope scope(stack);
+	Instance* node = this;
+	while (node->Parent && !node->Parent->pathCached) {
+		stack.push_back(node);
+		node = node->Parent;
+	}
+	if (node->Parent) {
+		const std::string& parentPath = node->Parent->cachedPath;
+		node->cachedPath.reserve(parentPath.size() + 1 + node->Name.size());
+		node->cachedPath.append(parentPath).append(1, '.').append(node->Name);
+	} else {
+		node->cachedPath = node->Name;
+	}
+	node->pathCached = true;
+	while (stack.size() > scope.base) {
+		Instance* child = stack.back();
+		stack.pop_back();
+		const std::string& parentPath = child->Parent->cachedPath;
+		child->cachedPath.reserve(parentPath.size() + 1 + child->Name.size());
+		child->cachedPath.append(parentPath).append(1, '.').append(child->Name);
+		child->pathCached = true;
+	}
+	return cachedPath;
+}
+
+void Instance::invalidatePaths() {
+	if (!pathCached) {
+		return;
+	}
+	//Walks Children directly: unloaded subtrees have nothing cached and should stay unloaded.
+	std::vector<Instance*>& stack = traversalStack();
+	TraversalScope scope(stack);
+	stack.push_back(this);
+	while (stack.size() > scope.base) {
+		Instance* node = stack.back();
+		stack.pop_back();
+		node->cachedPath.clear();
+		node->pathCached = false;
+		for (Instance* child : node->Children) {
+			if (child->pathCached) {
+				stack.push_back(child);
+			}
+		}
 	}
-	return Name;
 }
 
 bool Instance::IsDescendantOf(Instance* other) {
@@ -30,7 +181,13 @@ bool Instance::IsAncestorOf(Instance* other) {
 	return other->IsDescendantOf(this);
 }
 
-Instance* Instance::FindFirstChild(std::string name) {
+Instance* Instance::FindFirstChild(std::string_view name) {
+	if (unloadedSubtree) {
+		LoadSubtree();
+	}
+	if (childIndex) {
+		return childIndex->FindByName(name, Children);
+	}
 	for (auto& it : Children) {
 		if (it->Name == name) {
 			return it;
@@ -39,11 +196,62 @@ Instance* Instance::FindFirstChild(std::string name) {
 	return nullptr;
 }
 
-Instance* Instance::FindFirstChildOfClass(std::string className, bool allowSubClasses) {
+Instance* Instance::FindFirstDescendantByPath(std::string_view Path) {
+	//Cache keys are the root's Id followed by the path. Values are Ids, so a destroyed result is simply not found.
+	//A result from before a sibling reorder may no longer be the first match, the version catches that.
+	LRUCache<std::string, PathLookup>* cache = engine ? &engine->GetPathLookupCache() : nullptr;
+	std::string key;
+	if (cache) {
+		key.reserve(EngineUUID::SIZE + Path.size());
+		key.append(reinterpret_cast<const char*>(Id.bytes), EngineUUID::SIZE).append(Path);
+		PathLookup* cached = cache->Find(key);
+		if (cached && cached->version == engine->GetPathLookupVersion()) {
+			Instance* found = engine->FindInstance(cached->id);
+			if (found && found != this && found->IsDescendantOf(this)) {
+				//Still at that path if its full path is ours plus the relative path.
+				const std::string& foundPath = found->fullPath();
+				const std::string& rootPath = fullPath();
+				if (foundPath.size() == rootPath.size() + 1 + Path.size() && std::string_view(foundPath).substr(rootPath.size() + 1) == Path) {
+					return found;
+				}
+			}
+		}
+	}
+
+	Instance* node = this;
+	size_t start = 0;
+	while (node) {
+		size_t end = Path.find('.', start);
+		node = node->FindFirstChild(Path.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start));
+		if (end == std::string_view::npos) {
+			break;
+		}
+		start = end + 1;
+	}
+	if (node && cache) {
+		cache->Insert(key, { node->Id, engine->GetPathLookupVersion() });
+	}
+	return node;
+}
+
+Instance* Instance::FindFirstChildOfClass(std::string_view className, bool allowSubClasses) {
+	//Resolve the name once rather than doing a string IsA per child.
+	return FindFirstChildOfClass(Reflection::GetRegistry().GetClass(className), allowSubClasses);
+}
+
+Instance* Instance::FindFirstChildOfClass(const Reflection::Class* cls, bool allowSubClasses) {
+	if (!cls) {
+		return nullptr;
+	}
+	if (unloadedSubtree) {
+		LoadSubtree();
+	}
+	if (!allowSubClasses && childIndex && childIndex->HasClassIndex()) {
+		return childIndex->FindByClass(cls);
+	}
 	for (auto& it : Children) {
-		if (!allowSubClasses && it->ClassName() == className) {
-			return it;
-		} else if (allowSubClasses && it->IsA(className)) {
+		const Reflection::Class* childClass = it->GetClass();
+		if (childClass == cls || (allowSubClasses && childClass->IsA(cls))) {
 			return it;
 		}
 	}
@@ -51,62 +259,336 @@ Instance* Instance::FindFirstChildOfClass(std::string className, bool allowSubCl
 }
 
 bool Instance::IsA(std::string className) {
-	return reflectionClass->IsA(className);
+	return GetClass()->IsA(className);
 }
 bool Instance::__IsA(std::string className) {
 	return Base::__IsA(className);
 }
 
 void Instance::SetParent(Instance* newValue) {
-	if (newValue != Parent) {
-		Instance* oldParent = Parent;
-		Parent = newValue;
+	if (newValue == Parent) {
+		return;
+	}
+	if (destroyed || (newValue && newValue->destroyed)) {
+		throw std::runtime_error("Cannot parent " + Name + ", it or its new parent has been destroyed");
+	}
+	if (newValue && (newValue == this || newValue->IsDescendantOf(this))) {
+		throw std::runtime_error("Cannot parent " + Name + " to itself or one of its descendants");
+	}
+	Instance* oldParent = Parent;
+	Parent = newValue;
+	invalidatePaths();
+
+	Instance* const self = this;
+	if (oldParent != nullptr) {
+		oldParent->__onChildRemoved(this);
+		notifyDescendants(oldParent, { &self, 1 }, false);
+	}
+	if (Parent != nullptr) {
+		Parent->__onChildAdded(this);
+		notifyDescendants(Parent, { &self, 1 }, true);
+	}
+	__onParentChanged(newValue);
+	ObjectInstance::UpdateDescendantWorlds(this, ObjectInstance::FindWorld(oldParent));
+	raisePropChanged(prop_Parent);
+}
 
-		if (oldParent != nullptr) {
-			oldParent->__onChildRemoved(this);
+void Instance::MoveChildren(Instance* NewParent) {
+	if (unloadedSubtree) {
+		LoadSubtree();
+	}
+	if (NewParent != this) {
+		//Copied, Children is compacted while they move.
+		Reparent(std::vector<Instance*>(Children), NewParent);
+	}
+}
+
+void Instance::Reparent(const std::vector<Instance*>& instances, Instance* newParent) {
+	//Check the whole batch first so a bad entry leaves the tree untouched.
+	if (newParent && newParent->destroyed) {
+		throw std::runtime_error("Cannot parent to " + newParent->Name + ", it has been destroyed");
+	}
+	for (Instance* instance : instances) {
+		if (instance && instance->destroyed) {
+			throw std::runtime_error("Cannot parent " + instance->Name + ", it has been destroyed");
 		}
-		if (Parent != nullptr) {
-			Parent->__onChildAdded(this);
+	}
+	if (newParent) {
+		std::vector<Instance*> ancestry;
+		for (Instance* ancestor = newParent; ancestor; ancestor = ancestor->Parent) {
+			ancestry.push_back(ancestor);
 		}
-		__onParentChanged(newValue);
-		raisePropChanged(prop_Parent);
+		std::sort(ancestry.begin(), ancestry.end());
+		for (Instance* instance : instances) {
+			if (instance && std::binary_search(ancestry.begin(), ancestry.end(), instance)) {
+				throw std::runtime_error("Cannot parent " + instance->Name + " to itself or one of its descendants");
+			}
+		}
+	}
+
+	//Worlds as they are before anything moves, since moving one instance can change another's.
+	std::vector<World*> oldWorlds;
+	oldWorlds.reserve(instances.size());
+	for (Instance* instance : instances) {
+		oldWorlds.push_back(instance ? ObjectInstance::FindWorld(instance->Parent) : nullptr);
 	}
+
+	//Re-point every Parent up front, grouping the moved instances by old parent in first-seen order.
+	std::vector<Instance*> moved;
+	std::vector<World*> movedOldWorlds;
+	std::vector<std::pair<Instance*, std::vector<Instance*>>> removals;
+	std::unordered_map<Instance*, size_t> removalIndex;
+	for (size_t i = 0; i < instances.size(); i++) {
+		Instance* instance = instances[i];
+		if (!instance || instance->Parent == newParent) {
+			//Also skips duplicates, which already moved.
+			continue;
+		}
+		Instance* oldParent = instance->Parent;
+		instance->Parent = newParent;
+		instance->invalidatePaths();
+		moved.push_back(instance);
+		movedOldWorlds.push_back(oldWorlds[i]);
+		if (oldParent) {
+			auto [it, inserted] = removalIndex.try_emplace(oldParent, removals.size());
+			if (inserted) {
+				removals.emplace_back(oldParent, std::vector<Instance*>());
+			}
+			removals[it->second].second.push_back(instance);
+		}
+	}
+	if (moved.empty()) {
+		return;
+	}
+
+	//Restructure the whole tree before any listener runs, so nobody sees it half-moved and the
+	//subtrees gathered for notifications never include an instance that is moving separately.
+	for (auto& [oldParent, removed] : removals) {
+		oldParent->detachChildren(removed);
+	}
+	if (newParent) {
+		newParent->attachChildren(moved);
+	}
+
+	for (auto& [oldParent, removed] : removals) {
+		oldParent->raisePropChanged(prop_Children);
+		for (Instance* child : removed) {
+			oldParent->ChildRemoved.Fire(child);
+		}
+		notifyDescendants(oldParent, removed, false);
+	}
+	if (newParent) {
+		newParent->raisePropChanged(prop_Children);
+		for (Instance* child : moved) {
+			newParent->ChildAdded.Fire(child);
+		}
+		notifyDescendants(newParent, moved, true);
+	}
+	for (size_t i = 0; i < moved.size(); i++) {
+		moved[i]->__onParentChanged(newParent);
+		ObjectInstance::UpdateDescendantWorlds(moved[i], movedOldWorlds[i]);
+		moved[i]->raisePropChanged(prop_Parent);
+	}
+}
+
+Instance* Instance::Clone() {
+	if (!Archivable) {
+		return nullptr;
+	}
+
+	//The whole source tree in pre-order, so every parent comes before its children.
+	std::vector<Instance*> sources = { this };
+	ForEachDescendant([&](Instance* descendant) {
+		if (!descendant->Archivable) {
+			return TraversalAction::SkipChildren;
+		}
+		sources.push_back(descendant);
+		return TraversalAction::Continue;
+	});
+
+	//Create every clone before copying anything, so references to later instances can be remapped.
+	std::vector<Instance*> clones;
+	clones.reserve(sources.size());
+	std::unordered_map<const Instance*, Instance*> cloneOf;
+	cloneOf.reserve(sources.size());
+	try {
+		for (Instance* source : sources) {
+			Instance* clone = source->GetClass()->Instantiate(engine);
+			if (!clone) {
+				throw std::runtime_error("Cannot clone " + source->Name + ": class " + std::string(source->GetClass()->className) + " cannot be instantiated");
+			}
+			clones.push_back(clone);
+			cloneOf.emplace(source, clone);
+		}
+	} catch (...) {
+		for (Instance* clone : clones) {
+			clone->GetClass()->Destroy(clone);
+		}
+		throw;
+	}
+
+	for (size_t i = 0; i < sources.size(); i++) {
+		const Instance* source = sources[i];
+		Instance* clone = clones[i];
+		const Reflection::Class* cls = source->GetClass();
+
+		//Setters are bypassed: nothing can be listening to a fresh clone, and the tree is linked up below.
+		cls->CopyRawProperties(source, clone);
+		for (const Reflection::Property* prop : cls->propertyTable.copyableProperties) {
+			if (prop->id == prop_Parent) {
+				continue;
+			}
+			const Reflection::PropertyAccessor& accessor = prop->accessor;
+			void* field = accessor.FieldPointer(clone);
+			accessor.copy(field, accessor.FieldPointer(source));
+			if (prop->typeFlags == Reflection::PropTypeFlags::RawPointer || prop->typeFlags == Reflection::PropTypeFlags::InstanceRef) {
+				auto it = cloneOf.find(Reflection::ReadInstanceReference(prop->typeFlags, field));
+				if (it != cloneOf.end()) {
+					Reflection::WriteInstanceReference(prop->typeFlags, field, it->second);
+				}
+			}
+		}
+		//Derived properties have no field to copy, so they are the exception and go through the setter.
+		for (const Reflection::Property* prop : cls->propertyTable.derivedProperties) {
+			prop->accessor.copyValue(prop->accessor, source, clone);
+		}
+
+		if (i > 0) {
+			clone->Parent = cloneOf[source->Parent];
+			clone->Parent->attachChildren({ &clone, 1 });
+		}
+	}
+
+	//Let each clone react to its place in the new tree, parents before children.
+	for (size_t i = 1; i < clones.size(); i++) {
+		clones[i]->__onParentChanged(clones[i]->Parent);
+	}
+	return clones[0];
+}
+
+void Instance::LoadSubtree() {
+	if (unloadedSubtree) {
+		//The reader may be released along with the subtree, hold on to it until loading is done.
+		std::shared_ptr<PlaceReader> reader = unloadedSubtree->reader;
+		reader->LoadSubtree(this);
+	}
+}
+
+void Instance::PrefetchSubtree() {
+	if (!unloadedSubtree || unloadedSubtree->prefetch.valid()) {
+		return;
+	}
+	std::shared_ptr<PlaceReader> reader = unloadedSubtree->reader;
+	uint32_t index = unloadedSubtree->index;
+	if (!engine || engine->GetJobSystem().GetWorkerCount() == 0) {
+		unloadedSubtree->prefetch = std::async(std::launch::async, [reader, index]() {
+			reader->PrefetchSubtree(index);
+		}).share();
+		return;
+	}
+	//LoadSubtree blocks on the future, so a worker has to be the one to run it.
+	std::shared_ptr<std::promise<void>> done = std::make_shared<std::promise<void>>();
+	unloadedSubtree->prefetch = done->get_future().share();
+	engine->GetJobSystem().Submit([reader, index, done]() {
+		try {
+			reader->PrefetchSubtree(index);
+			done->set_value();
+		} catch (...) {
+			done->set_exception(std::current_exception());
+		}
+	});
 }
 
 void Instance::__onChildAdded(Instance* child) {
-	Children.push_back(child);
+	attachChildren({ &child, 1 });
 	raisePropChanged(prop_Children);
 
 	ChildAdded.Fire(child);
 }
 
 void Instance::__onChildRemoved(Instance* child) {
-	for (auto it = Children.rbegin(); it != Children.rend(); it++) {
-		if (*it == child) {
-			Children.erase(--(it.base()));
-			raisePropChanged(prop_Children);
+	detachChildren({ &child, 1 });
+	raisePropChanged(prop_Children);
 
-			ChildRemoved.Fire(child);
+	ChildRemoved.Fire(child);
+}
 
-			if (Parent) {
-				Parent->__onDescendantRemoved(child, this);
-			}
-			break;
+void Instance::attachChildren(std::span<Instance* const> added) {
+	Children.insert(Children.end(), added.begin(), added.end());
+	if (childIndex) {
+		for (Instance* child : added) {
+			childIndex->OnChildAdded(child);
 		}
+	} else if (Children.size() >= ChildIndex::Threshold) {
+		childIndex = std::make_unique<ChildIndex>(Children);
 	}
 }
 
-void Instance::__onDescendantAdded(Instance* child, Instance* parent) {
-	DescendantAdded.Fire(child, parent);
-	if (Parent) {
-		Parent->__onDescendantAdded(child, parent);
+void Instance::detachChildren(std::span<Instance* const> removed) {
+	if (removed.size() == 1) {
+		//Recently added children are the likeliest to leave again, look from the back.
+		auto it = std::find(Children.rbegin(), Children.rend(), removed[0]);
+		if (it != Children.rend()) {
+			Children.erase(--(it.base()));
+			if (childIndex) {
+				childIndex->OnChildRemoved(removed[0], Children);
+			}
+			//A later sibling of the same name may have just become the first one.
+			if (isTracked() && FindFirstChild(removed[0]->Name)) {
+				engine->InvalidatePathLookups();
+			}
+		}
+		return;
+	}
+	std::erase_if(Children, [this](Instance* child) { return child->Parent != this; });
+	if (childIndex) {
+		//Cheaper than refreshing the index once per removed child.
+		childIndex = std::make_unique<ChildIndex>(Children);
+	}
+	if (isTracked()) {
+		engine->InvalidatePathLookups();
 	}
 }
 
-void Instance::__onDescendantRemoved(Instance* child, Instance* parent) {
-	DescendantRemoved.Fire(child, parent);
-	if (Parent) {
-		Parent->__onDescendantRemoved(child, parent);
+void Instance::notifyDescendants(Instance* parent, std::span<Instance* const> roots, bool added) {
+	std::vector<Instance*> listening;
+	for (Instance* ancestor = parent; ancestor; ancestor = ancestor->Parent) {
+		bool hasListeners = added
+			? ancestor->DescendantAdded.HasAnyListeners() || ancestor->DescendantsAdded.HasAnyListeners()
+			: ancestor->DescendantRemoved.HasAnyListeners() || ancestor->DescendantsRemoved.HasAnyListeners();
+		if (hasListeners) {
+			listening.push_back(ancestor);
+		}
+	}
+	if (listening.empty()) {
+		return;
+	}
+
+	//Each root is followed by its descendants, paired with their (former) immediate parents.
+	std::vector<Instance*> nodes;
+	std::vector<Instance*> nodeParents;
+	for (Instance* root : roots) {
+		size_t first = nodes.size();
+		nodes.push_back(root);
+		nodeParents.push_back(parent);
+		//Unloaded subtrees are announced by LoadSubtree() when they arrive, loading them here would announce them twice.
+		root->ForEachLoadedDescendant([&](Instance* descendant) {
+			nodes.push_back(descendant);
+		});
+		for (size_t i = first + 1; i < nodes.size(); i++) {
+			nodeParents.push_back(nodes[i]->Parent);
+		}
+	}
+
+	for (Instance* ancestor : listening) {
+		MulticastEvent<std::span<Instance* const>>& batchEvent = added ? ancestor->DescendantsAdded : ancestor->DescendantsRemoved;
+		MulticastEvent<Instance*, Instance*>& nodeEvent = added ? ancestor->DescendantAdded : ancestor->DescendantRemoved;
+		batchEvent.Fire(nodes);
+		if (nodeEvent.HasAnyListeners()) {
+			for (size_t i = 0; i < nodes.size(); i++) {
+				nodeEvent.Fire(nodes[i], nodeParents[i]);
+			}
+		}
 	}
 }
 
@@ -114,18 +596,51 @@ void Instance::__onParentChanged(Instance* newParent) {
 	//no-op
 }
 
-namespace Reflection {
-	void TrySetClass(Instance* obj, Class* cls) {
-		obj->SetClass(cls);
+bool Instance::queuePropertyChanges() {
+	if (!engine) {
+		return false;
+	}
+	engine->GetPropertyChangeJournal().Record(this);
+	return true;
+}
+
+void Instance::firePropertyChanged(uint64_t propId) {
+	PropertyChanged.Fire(propId);
+	if (LuaPropertyChanged.HasAnyListeners()) {
+		LuaPropertyChanged.Fire(std::string(GetClass()->GetPropName(propId)));
 	}
 }
 
+void Instance::OnNameChanged() {
+	if (Parent && Parent->childIndex) {
+		Parent->childIndex->OnChildRenamed(this, Parent->Children);
+	}
+	//The instance may now come before, or no longer come before, a sibling of the same name.
+	if (Parent && isTracked()) {
+		engine->InvalidatePathLookups();
+	}
+	invalidatePaths();
+}
+
 std::vector<Instance*> Instance::GetDescendants() {
 	std::vector<Instance*> descendants;
-	for (auto child : Children) {
-		descendants.push_back(child);
-		auto childDescendants = child->GetDescendants();
-		descendants.insert(descendants.end(), childDescendants.begin(), childDescendants.end());
-	}
+	GetDescendants(descendants);
 	return descendants;
-}
\ No newline at end of file
+}
+
+void Instance::GetDescendants(std::vector<Instance*>& out) {
+	ForEachDescendant([&](Instance* descendant) {
+		out.push_back(descendant);
+	});
+}
+
+void Instance::GetDescendantsOfClass(const Reflection::Class* cls, std::vector<Instance*>& out) {
+	ForEachDescendantOfClass(cls, [&](Instance* descendant) {
+		out.push_back(descendant);
+	});
+}
+
+std::vector<Instance*>& Instance::traversalStack() {
+	thread_local std::vector<Instance*> stack;
+	return stack;
+}
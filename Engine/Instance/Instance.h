@@ -11,14 +11,27 @@
 #pragma once
 #include "Instance/UUID.h"
 #include "Instance/Reflection.h"
+#include "Instance/ChildIndex.h"
+#include "Instance/InstanceRef.h"
 #include "Core/Event.h"
 
 #include <string>
+#include <string_view>
+#include <span>
 #include <memory>
+#include <type_traits>
 #include <unordered_map>
 #include "Instance.generated.h"
 
 class Engine;
+struct UnloadedSubtree;
+
+/// Returned by a ForEachDescendant visitor to steer the traversal.
+enum class TraversalAction : uint8_t {
+	Continue,
+	SkipChildren,
+	Stop
+};
 
 template<typename Derived>
 class BaseInstance {
@@ -36,7 +49,8 @@ class [[reflect()]] Instance : BaseInstance<Instance> {
 	REFLECTION()
 public: //reflected properties
 
-	/// Do not change at runtime unless you know what you're doing.
+	/// Do not change at runtime unless you know what you're doing, and then only through AssignId,
+	/// which keeps the engine's instance index in sync.
 	[[reflect(Hidden, ReadOnly, Replicated)]]
 	[[summary("An internal universally unique identifier for the instance.")]]
 	EngineUUID Id;
@@ -59,13 +73,13 @@ public: //reflected properties
 
 	[[reflect(Replicated, Hidden)]]
 	[[argNames("uint64_t", "PropId")]]
-	[[summary("Used internally for network replication of property changes.")]]
+	[[summary("Used internally for network replication of property changes. Fires once per changed property when the engine flushes its change journal at the end of the frame.")]]
 	MulticastEvent<uint64_t> PropertyChanged;
 	
 	[[reflect()]]
 	[[boundName("Changed")]]
 	[[argNames("PropName")]]
-	[[summary("Fires when a property is changed.")]]
+	[[summary("Fires when a property is changed. Changes are coalesced, so this fires at most once per property per frame, after the engine's systems have updated.")]]
 	MulticastEvent<std::string> LuaPropertyChanged;
 
 	[[reflect()]]
@@ -80,16 +94,23 @@ public: //reflected properties
 
 	[[reflect()]]
 	[[argNames("Child", "Parent")]] 
-	[[summary("Fires when any descendant of this instance is added, and receives both the new descendant and its immediate parent. The immediate parent can be this instance. Fires immediately after ChildAdded is fired on the immediate parent.")]]
+	[[summary("Fires when any descendant of this instance is added, and receives both the new descendant and its immediate parent. The immediate parent can be this instance. Fires once for every instance in a subtree that is moved in, after ChildAdded has fired on the immediate parent.")]]
 	MulticastEvent<Instance*, Instance*> DescendantAdded;
 
 	[[reflect()]]
 	[[argNames("Child", "Parent")]]
-	[[summary("Fires when any descendant of this instance is removed, and receives both the removed descendant and its former immediate parent. The immediate parent can be this instance. Fires immediately after ChildRemoved is fired on the immediate parent.")]]
+	[[summary("Fires when any descendant of this instance is removed, and receives both the removed descendant and its former immediate parent. The immediate parent can be this instance. Fires once for every instance in a subtree that is moved out, after ChildRemoved has fired on the immediate parent.")]]
 	MulticastEvent<Instance*, Instance*> DescendantRemoved;
 
+	/// Fires once per move on each ancestor of the new parent (the new parent included) with every instance
+	/// entering its subtree, each moved instance followed by its own descendants in pre-order. Fires before
+	/// the per-instance DescendantAdded events, and is the cheaper of the two to listen to for large moves.
+	MulticastEvent<std::span<Instance* const>> DescendantsAdded;
+	/// As DescendantsAdded, for the ancestors of the old parent and the instances leaving their subtree.
+	MulticastEvent<std::span<Instance* const>> DescendantsRemoved;
+
 	[[reflect()]] 
-	[[summary("Returns a string representing the instance's location in the hierarchy, using '.' to separate names. If RelativeTo is provided, the path will be relative to that instance. If RelativeTo is not an ancestor of this instance, the full path will be returned.")]]
+	[[summary("Returns a string representing the instance's location in the hierarchy, using '.' to separate names. If RelativeTo is provided, the path will be relative to that instance. If RelativeTo is not an ancestor of this instance, the full path will be returned. Full paths are cached until the instance or one of its ancestors is renamed or moved.")]]
 	std::string GetPath(Instance* RelativeTo = nullptr);
 
 	[[reflect()]]
@@ -102,11 +123,62 @@ public: //reflected properties
 
 	[[reflect()]]
 	[[summary("Finds the first child with the given name, or nil if no such child exists.")]]
-	Instance* FindFirstChild(std::string name);
+	Instance* FindFirstChild(std::string_view name);
 
 	[[reflect()]]
 	[[summary("Finds the first child of the given class, or nil if no such child exists. The optional second argument allows an \"IsA\" class check (the instance may be a subclass of the className provided.) and defaults to true.")]]
-	Instance* FindFirstChildOfClass(std::string className, bool allowSubClasses = true);
+	Instance* FindFirstChildOfClass(std::string_view className, bool allowSubClasses = true);
+
+	Instance* FindFirstChildOfClass(const Reflection::Class* cls, bool allowSubClasses = true);
+
+	template<typename T>
+	T* FindFirstChildOfClass(bool allowSubClasses = true) {
+		return static_cast<T*>(FindFirstChildOfClass(&T::StaticClass(), allowSubClasses));
+	}
+
+	[[reflect()]]
+	[[summary("Finds the descendant at the given path, made of '.'-separated names starting from a child of this instance, as returned by GetPath with this instance as RelativeTo. Returns nil if any step is missing. Each step takes the first child with that name, and recent lookups are cached per engine.")]]
+	Instance* FindFirstDescendantByPath(std::string_view Path);
+
+	[[reflect()]]
+	[[summary("False while this instance's descendants are still waiting to be streamed in from a place file. They are loaded the first time FindFirstChild, FindFirstChildOfClass, GetDescendants or LoadSubtree is called on it.")]]
+	bool IsSubtreeLoaded() const { return !unloadedSubtree; }
+
+	/// Materializes descendants that are still in the place file this instance was streamed from, firing
+	/// ChildAdded and DescendantAdded for them. Children is a plain field, so code reading it directly sees
+	/// a stub as childless until this runs; the lookups and traversals on Instance call it on first touch.
+	/// Waits for a prefetch in progress. Does nothing if the subtree is already loaded.
+	void LoadSubtree();
+	/// Starts paging the unloaded descendants in on one of the engine's job workers, so that the LoadSubtree()
+	/// on first touch does not stall on I/O. Instances are still created on the calling thread, by LoadSubtree().
+	void PrefetchSubtree();
+
+	[[reflect()]]
+	[[summary("Returns a copy of this instance and all of its descendants, with no parent. Descendants whose Archivable is false are left out along with their own descendants, and nil is returned if this instance is not Archivable. References between instances inside the copied tree are pointed at their copies, while references to anything outside it are kept as they are.")]]
+	Instance* Clone();
+
+	[[reflect()]]
+	[[summary("Moves all children of this instance to NewParent, as if SetParent was called on each of them in order, but notifying every ancestor once for the whole move.")]]
+	void MoveChildren(Instance* NewParent);
+
+	/// Moves every instance in instances under newParent (nullptr to unparent them) as a single operation.
+	/// Events are the same as calling SetParent on each in turn, except that each old parent's Children is
+	/// compacted once, and the ancestors of the old and new parents are walked once for the whole batch rather
+	/// than once per moved instance. Null entries and instances already under newParent are skipped.
+	/// Throws if newParent is one of the instances or a descendant of one, before anything has moved.
+	static void Reparent(const std::vector<Instance*>& instances, Instance* newParent);
+
+	[[reflect()]]
+	[[summary("Removes the instance and its descendants from the tree for good. They are detached from the parent, disconnected from every listener and can no longer be reparented or found by Id or class, but stay in memory until the end of the frame so code still holding them is safe. Outside an engine they are freed right away.")]]
+	void Destroy();
+
+	[[reflect()]]
+	[[summary("Returns true once Destroy has been called on this instance or one of its ancestors.")]]
+	bool IsDestroyed() const { return destroyed; }
+
+	/// Replaces Id and re-files the instance under it in the engine's instance index. Used when an
+	/// instance is restored from a place or created on behalf of a remote peer.
+	void AssignId(const EngineUUID& id);
 
 	[[reflect()]]
 	[[summary("Returns true if this instance is of the given class or a subclass of it, false otherwise.")]]
@@ -116,17 +188,60 @@ public: //reflected properties
 	[[summary("Returns all descendants of this instance.")]]
 	std::vector<Instance*> GetDescendants();
 
-	template<typename T>
-	bool IsA() const {
-		return reflectionClass->IsA(T::StaticClass().id);
+	/// Appends all descendants to out, in the same order as GetDescendants, without allocating
+	/// beyond what out itself needs.
+	void GetDescendants(std::vector<Instance*>& out);
+	/// Appends all descendants that are (or derive from) cls to out.
+	void GetDescendantsOfClass(const Reflection::Class* cls, std::vector<Instance*>& out);
+
+	/// Visits every descendant depth-first, in pre-order. The visitor takes an Instance* and may
+	/// return a TraversalAction to skip a subtree or stop early; a void visitor visits everything.
+	/// Uses an explicit stack, so arbitrarily deep trees are fine, and visitors may start nested
+	/// traversals. Returns false if the visitor stopped the traversal.
+	template<typename Visitor>
+	bool ForEachDescendant(Visitor&& visitor) {
+		return traverseDescendants(visitor, true);
+	}
+
+	/// As ForEachDescendant, but unloaded subtrees are left alone rather than loaded. For bookkeeping that
+	/// LoadSubtree() does for the new instances itself, such as descendant events and world membership.
+	template<typename Visitor>
+	bool ForEachLoadedDescendant(Visitor&& visitor) {
+		return traverseDescendants(visitor, false);
 	}
 
-	void SetClass(Reflection::Class* cls) {
-		reflectionClass = cls;
+	/// As ForEachDescendant, but only calls the visitor for descendants that are (or derive from) cls.
+	/// The rest of the tree is still walked through.
+	template<typename Visitor>
+	bool ForEachDescendantOfClass(const Reflection::Class* cls, Visitor&& visitor) {
+		return ForEachDescendant([&](Instance* node) {
+			if (!node->GetClass()->IsA(cls)) {
+				return TraversalAction::Continue;
+			}
+			return visit(visitor, node);
+		});
 	}
 
-	Reflection::Class* GetClass() const {
-		return reflectionClass;
+	template<typename T, typename Visitor>
+	bool ForEachDescendantOfClass(Visitor&& visitor) {
+		return ForEachDescendantOfClass(&T::StaticClass(), [&](Instance* node) {
+			return visit(visitor, static_cast<T*>(node));
+		});
+	}
+
+	template<typename T, typename Visitor>
+	bool ForEachLoadedDescendantOfClass(Visitor&& visitor) {
+		return ForEachLoadedDescendant([&](Instance* node) {
+			if (!node->IsA<T>()) {
+				return TraversalAction::Continue;
+			}
+			return visit(visitor, static_cast<T*>(node));
+		});
+	}
+
+	template<typename T>
+	bool IsA() const {
+		return GetClass()->IsA(&T::StaticClass());
 	}
 	
 public: // reflected property getters and setters
@@ -136,26 +251,159 @@ public: // reflected property getters and setters
 	Instance* GetParent() { return Parent; }
 
 protected:
-	Reflection::Class* reflectionClass = &Reflection::reflected_Instance;
-
 	void __onChildAdded(Instance* child);
 	void __onChildRemoved(Instance* child);
-	void __onDescendantAdded(Instance* child, Instance* parent);
-	void __onDescendantRemoved(Instance* child, Instance* parent);
-	void __onParentChanged(Instance* newParent);
+	virtual void __onParentChanged(Instance* newParent);
+
+	/// True if this instance is kept in its engine's instance index and registry.
+	bool isTracked() const;
+
+	/// Appends children to Children and keeps the ChildIndex in step. No events.
+	void attachChildren(std::span<Instance* const> added);
+	/// Erases children from Children and keeps the ChildIndex in step. Each must already have its new
+	/// Parent set, which lets a batch be erased in one pass. No events.
+	void detachChildren(std::span<Instance* const> removed);
+
+	/// Fires DescendantAdded/DescendantsAdded (or the Removed pair) on parent and each of its ancestors for
+	/// roots, which were just attached to (or detached from) parent, and everything loaded below them.
+	/// The ancestors are walked once, and the subtrees are only gathered if one of them is listening.
+	static void notifyDescendants(Instance* parent, std::span<Instance* const> roots, bool added);
 
 	static bool __IsA(std::string className);
 
+	/// Takes the instance out of its engine's journal, index and registry and frees its slot.
+	void retire();
+	void disconnectEvents();
+
+	void OnNameChanged();
+
+	/// Per-thread scratch stack shared by all traversals on that thread. Nested traversals push
+	/// above their caller's entries and truncate back to where they started.
+	static std::vector<Instance*>& traversalStack();
+
+	struct TraversalScope {
+		std::vector<Instance*>& stack;
+		size_t base;
+
+		explicit TraversalScope(std::vector<Instance*>& _stack) : stack(_stack), base(_stack.size()) {}
+		~TraversalScope() { stack.resize(base); }
+	};
+
+	static void pushChildren(std::vector<Instance*>& stack, Instance* node, bool loadSubtrees) {
+		if (loadSubtrees && node->unloadedSubtree) {
+			node->LoadSubtree();
+		}
+		//Reversed, so children pop off in order.
+		stack.insert(stack.end(), node->Children.rbegin(), node->Children.rend());
+	}
+
+	template<typename Visitor>
+	bool traverseDescendants(Visitor& visitor, bool loadSubtrees) {
+		std::vector<Instance*>& stack = traversalStack();
+		TraversalScope scope(stack);
+		pushChildren(stack, this, loadSubtrees);
+		while (stack.size() > scope.base) {
+			Instance* node = stack.back();
+			stack.pop_back();
+			TraversalAction action = visit(visitor, node);
+			if (action == TraversalAction::Stop) {
+				return false;
+			}
+			if (action == TraversalAction::Continue) {
+				pushChildren(stack, node, loadSubtrees);
+			}
+		}
+		return true;
+	}
+
+	template<typename Visitor, typename Node>
+	static TraversalAction visit(Visitor& visitor, Node* node) {
+		if constexpr (std::is_void_v<std::invoke_result_t<Visitor&, Node*>>) {
+			visitor(node);
+			return TraversalAction::Continue;
+		} else {
+			return visitor(node);
+		}
+	}
+
+	/// Records a change of propId, whose dense index in the class's property table is the set bit of propBit,
+	/// for delivery when the engine flushes its PropertyChangeJournal. Outside an engine nothing flushes, so the
+	/// change is delivered right away. Called by the generated raisePropChanged.
+	void recordPropertyChanged(uint64_t propId, uint64_t propBit) {
+		if (!markPropertyDirty(propBit)) {
+			firePropertyChanged(propId);
+		}
+	}
+	/// Sets propBit in dirtyProps, queueing this instance in the engine's journal if nothing was dirty yet.
+	/// Returns false outside an engine, where dirty properties are not tracked.
+	bool markPropertyDirty(uint64_t propBit) {
+		if (dirtyProps == 0 && !queuePropertyChanges()) {
+			return false;
+		}
+		dirtyProps |= propBit;
+		return true;
+	}
+	bool queuePropertyChanges();
+	/// Fires PropertyChanged and, if anything listens, the Lua Changed event with the property's name.
+	void firePropertyChanged(uint64_t propId);
+
+	friend class PropertyChangeJournal;
+	/// Bit i set means GetClass()->propertyTable.properties[i] changed since the engine's journal last flushed.
+	uint64_t dirtyProps = 0;
+
+	friend class InstanceRegistry;
+	/// Where this instance sits in its engine's InstanceRegistry.
+	struct RegistryHook {
+		uint32_t list = 0;
+		uint32_t position = 0;
+		uint32_t tagCount = 0;
+	} registryHook;
+
+	friend class ChildIndex;
+	/// Links loaded instances into their trees without going through SetParent.
+	friend class PlaceReader;
+	/// Set on instances streamed from a place file whose descendants have not been materialized yet.
+	std::unique_ptr<UnloadedSubtree> unloadedSubtree;
+	/// Built once Children grows past ChildIndex::Threshold.
+	std::unique_ptr<ChildIndex> childIndex;
+	/// Name hash this instance is filed under in its parent's ChildIndex.
+	uint64_t indexedNameHash = 0;
+
+	/// Full path as returned by GetPath(), valid while pathCached is set: computed, and no rename or move of this
+	/// instance or an ancestor since. Only cached while the parent's path is cached too, so invalidation can stop
+	/// at the first descendant without one. A flag rather than an empty string, since names may be empty.
+	std::string cachedPath;
+	bool pathCached = false;
+	const std::string& fullPath();
+	/// Clears cachedPath on this instance and every descendant that has one.
+	void invalidatePaths();
+
 	std::unordered_map<std::string, MulticastEvent<>> luaPropChangeEvents;
 
 	Engine* engine;
+	/// This instance's slot in the InstanceSlotTable, or InstanceSlotTable::NoSlot once destroyed.
+	uint32_t refSlot;
+	/// Set by Destroy(), which has already taken the instance out of the engine's lookups.
+	bool destroyed = false;
+	template<typename T, typename... Args>
+	friend T* Reflection::PoolNew(Args&&... args);
+	/// Set by Reflection::PoolNew for instances made by Instantiate(). Instances built with a bare new are
+	/// deleted instead of being handed back to a class pool.
+	bool pooled = false;
+
+	/// Frees a destroyed instance the way it was allocated.
+	static void freeInstance(Instance* instance);
 
 public:
 	Engine* GetEngine() {
 		return engine;
 	}
+	uint32_t GetRefSlot() const {
+		return refSlot;
+	}
 	Instance(Engine* _engine);
 	Instance() = delete;
+	virtual ~Instance();
 };
 
 REFLECTION_END()
@@ -0,0 +1,56 @@
+#include "Instance/InstancePool.h"
+#include <algorithm>
+#include <cassert>
+
+namespace Reflection {
+
+	InstancePool::InstancePool(size_t objectSize, size_t objectAlignment)
+		: alignment(std::max(objectAlignment, CacheLineSize)) {
+		size_t size = std::max(objectSize, sizeof(FreeSlot));
+		stats.slotSize = (size + alignment - 1) / alignment * alignment;
+		stats.slotsPerChunk = std::max(MinSlotsPerChunk, TargetChunkBytes / stats.slotSize);
+	}
+
+	InstancePool::~InstancePool() {
+		for (std::byte* chunk : chunks) {
+			::operator delete(chunk, std::align_val_t(alignment));
+		}
+	}
+
+	void* InstancePool::Allocate() {
+		if (!freeList) {
+			allocateChunk();
+		}
+		FreeSlot* slot = freeList;
+		freeList = slot->next;
+
+		stats.liveCount++;
+		stats.totalAllocations++;
+		stats.peakLiveCount = std::max(stats.peakLiveCount, stats.liveCount);
+		return slot;
+	}
+
+	void InstancePool::Free(void* slot) {
+		if (!slot) return;
+		assert(stats.liveCount > 0 && "InstancePool::Free called more times than Allocate!");
+
+		FreeSlot* freed = static_cast<FreeSlot*>(slot);
+		freed->next = freeList;
+		freeList = freed;
+		stats.liveCount--;
+	}
+
+	void InstancePool::allocateChunk() {
+		size_t chunkBytes = stats.slotSize * stats.slotsPerChunk;
+		std::byte* chunk = static_cast<std::byte*>(::operator new(chunkBytes, std::align_val_t(alignment)));
+		chunks.push_back(chunk);
+		stats.chunkCount = chunks.size();
+
+		//Thread the new slots onto the free list back to front so they are handed out in address order.
+		for (size_t i = stats.slotsPerChunk; i-- > 0;) {
+			FreeSlot* slot = reinterpret_cast<FreeSlot*>(chunk + i * stats.slotSize);
+			slot->next = freeList;
+			freeList = slot;
+		}
+	}
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <new>
+#include <utility>
+#include "Core/Export.h"
+
+class Instance;
+
+namespace Reflection {
+
+	/// Snapshot of a pool's memory usage, reported per reflected class.
+	struct InstancePoolStats {
+		size_t slotSize = 0;
+		size_t slotsPerChunk = 0;
+		size_t chunkCount = 0;
+		size_t liveCount = 0;
+		size_t peakLiveCount = 0;
+		size_t totalAllocations = 0;
+
+		size_t CapacityCount() const { return slotsPerChunk * chunkCount; }
+		size_t ReservedBytes() const { return slotSize * CapacityCount(); }
+		double Occupancy() const {
+			size_t capacity = CapacityCount();
+			return capacity ? static_cast<double>(liveCount) / static_cast<double>(capacity) : 0.0;
+		}
+	};
+
+	/// Fixed-size slab allocator backing a single reflected class.
+	/// Slots are cache-line aligned and carved out of contiguous chunks; freed slots
+	/// are recycled LIFO so recently released (and still cache-warm) memory is reused first.
+	/// Chunks are never returned to the system while the pool is alive.
+	/// Not thread-safe: instances are created and released on the simulation thread.
+	class GP_EXPORT InstancePool {
+	public:
+		static constexpr size_t CacheLineSize = 64;
+		static constexpr size_t TargetChunkBytes = 64 * 1024;
+		static constexpr size_t MinSlotsPerChunk = 16;
+
+		InstancePool(size_t objectSize, size_t objectAlignment);
+		~InstancePool();
+
+		InstancePool(const InstancePool&) = delete;
+		InstancePool& operator=(const InstancePool&) = delete;
+
+		void* Allocate();
+		void Free(void* slot);
+
+		const InstancePoolStats& GetStats() const { return stats; }
+
+	private:
+		struct FreeSlot {
+			FreeSlot* next;
+		};
+
+		size_t alignment;
+		std::vector<std::byte*> chunks;
+		FreeSlot* freeList = nullptr;
+		InstancePoolStats stats;
+
+		void allocateChunk();
+	};
+
+	/// One pool per concrete type, created on first use.
+	template<typename T>
+	InstancePool& GetInstancePool() {
+		static InstancePool pool(sizeof(T), alignof(T));
+		return pool;
+	}
+
+	/// Constructs a T inside a slot from its class pool. Used by the generated instantiate_X functions.
+	template<typename T, typename... Args>
+	T* PoolNew(Args&&... args) {
+		InstancePool& pool = GetInstancePool<T>();
+		void* slot = pool.Allocate();
+		T* obj;
+		try {
+			obj = new (slot) T(std::forward<Args>(args)...);
+		} catch (...) {
+			pool.Free(slot);
+			throw;
+		}
+		//Tells Instance::Destroy() to hand the slot back rather than delete it.
+		obj->pooled = true;
+		return obj;
+	}
+
+	/// Destroys an instance created by PoolNew<T> and returns its slot to the pool.
+	template<typename T>
+	void PoolDelete(::Instance* inst) {
+		if (!inst) return;
+		T* obj = static_cast<T*>(inst);
+		obj->~T();
+		GetInstancePool<T>().Free(obj);
+	}
+}
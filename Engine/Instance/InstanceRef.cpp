@@ -0,0 +1,54 @@
+#include "Instance/InstanceRef.h"
+#include "Instance/Instance.h"
+
+uint32_t InstanceSlotTable::Acquire(Instance* instance) {
+	uint32_t slot;
+	if (freeHead != NoSlot) {
+		slot = freeHead;
+		freeHead = entries[slot].nextFree;
+	} else {
+		slot = static_cast<uint32_t>(entries.size());
+		entries.emplace_back();
+	}
+	entries[slot].instance = instance;
+	return slot;
+}
+
+void InstanceSlotTable::Release(uint32_t slot) {
+	Entry& entry = entries[slot];
+	entry.instance = nullptr;
+	//Generation 0 is reserved for empty references.
+	if (++entry.generation == 0) {
+		entry.generation = 1;
+	}
+	entry.nextFree = freeHead;
+	freeHead = slot;
+}
+
+InstanceSlotTable& GetInstanceSlots() {
+	static InstanceSlotTable table;
+	return table;
+}
+
+namespace Reflection {
+	::Instance* ReadInstanceReference(PropTypeFlags typeFlags, const void* field) {
+		if (typeFlags == PropTypeFlags::InstanceRef) {
+			//Every InstanceRef<T> has the same layout.
+			return static_cast<const InstanceRef<>*>(field)->Get();
+		}
+		//Reflected classes derive from Instance first, so an instance pointer field holds the Instance address.
+		return *static_cast<::Instance* const*>(field);
+	}
+
+	void WriteInstanceReference(PropTypeFlags typeFlags, void* field, ::Instance* target) {
+		if (typeFlags == PropTypeFlags::InstanceRef) {
+			*static_cast<InstanceRef<>*>(field) = InstanceRef<>(target);
+			return;
+		}
+		*static_cast<::Instance**>(field) = target;
+	}
+
+	bool InstanceIsA(const ::Instance* instance, const Class* cls) {
+		return instance->GetClass()->IsA(cls);
+	}
+}
@@ -0,0 +1,122 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+#include "Core/Export.h"
+#include "Instance/Reflection.h"
+
+class Instance;
+
+/// Process-wide table giving every live instance a 32-bit slot. A slot's generation is bumped when its
+/// instance is destroyed, so InstanceRefs taken before then stop matching and resolve to null, in O(1)
+/// and without touching the destroyed instance. Released slots are reused LIFO; generation 0 is never
+/// handed out, so a zeroed InstanceRef is always null.
+/// Not thread-safe: instances are created and destroyed on the simulation thread.
+class GP_EXPORT InstanceSlotTable {
+public:
+	static constexpr uint32_t NoSlot = ~0u;
+
+	InstanceSlotTable() = default;
+	InstanceSlotTable(const InstanceSlotTable&) = delete;
+	InstanceSlotTable& operator=(const InstanceSlotTable&) = delete;
+
+	/// Called by the Instance constructor.
+	uint32_t Acquire(Instance* instance);
+	/// Called when the instance is destroyed. Invalidates every reference to the slot's instance.
+	void Release(uint32_t slot);
+
+	/// The instance in slot, or null if it was destroyed since generation was taken.
+	Instance* Resolve(uint32_t slot, uint32_t generation) const {
+		if (slot >= entries.size()) {
+			return nullptr;
+		}
+		const Entry& entry = entries[slot];
+		return entry.generation == generation ? entry.instance : nullptr;
+	}
+	uint32_t GetGeneration(uint32_t slot) const { return entries[slot].generation; }
+
+	size_t GetCapacity() const { return entries.size(); }
+
+private:
+	struct Entry {
+		Instance* instance = nullptr;
+		uint32_t generation = 1;
+		/// Next released slot while this one is released.
+		uint32_t nextFree = NoSlot;
+	};
+
+	std::vector<Entry> entries;
+	uint32_t freeHead = NoSlot;
+};
+
+GP_EXPORT InstanceSlotTable& GetInstanceSlots();
+
+namespace Reflection {
+	/// The instance a RawPointer or InstanceRef property field refers to.
+	GP_EXPORT ::Instance* ReadInstanceReference(PropTypeFlags typeFlags, const void* field);
+	/// Points a RawPointer or InstanceRef property field at target, bypassing the setter.
+	GP_EXPORT void WriteInstanceReference(PropTypeFlags typeFlags, void* field, ::Instance* target);
+	/// instance->IsA(cls), for code that cannot see the Instance definition.
+	GP_EXPORT bool InstanceIsA(const ::Instance* instance, const Class* cls);
+}
+
+/// Weak reference to an instance: a slot in the InstanceSlotTable plus the generation it had when the
+/// reference was taken. Resolves to null once the instance is destroyed instead of dangling, and packs
+/// into 8 bytes, so it can be handed to replication or stored in Lua userdata and checked again later
+/// without a lookup by Id. Slots are only meaningful inside the running process; place files store
+/// references as indices into their own instance table.
+template<typename T = Instance>
+class InstanceRef {
+public:
+	/// Lets Reflection::MakePropertyAccessor tell references apart from plain trivially copyable fields.
+	static constexpr bool IsInstanceReference = true;
+
+	InstanceRef() = default;
+	InstanceRef(std::nullptr_t) {}
+	/// Empty if instance is null or already destroyed.
+	InstanceRef(T* instance) {
+		if (instance && instance->GetRefSlot() != InstanceSlotTable::NoSlot) {
+			slot = instance->GetRefSlot();
+			generation = GetInstanceSlots().GetGeneration(slot);
+		}
+	}
+	template<typename U> requires (std::is_base_of_v<T, U> && !std::is_same_v<T, U>)
+	InstanceRef(const InstanceRef<U>& other) : slot(other.GetSlot()), generation(other.GetGeneration()) {}
+
+	/// The instance, or null if it has been destroyed or the reference is empty.
+	T* Get() const {
+		//Reflected classes derive from Instance first, so the slot's Instance address is the T address.
+		return static_cast<T*>(GetInstanceSlots().Resolve(slot, generation));
+	}
+	T* operator->() const { return Get(); }
+	explicit operator bool() const { return Get() != nullptr; }
+
+	bool operator==(const InstanceRef& other) const = default;
+
+	uint32_t GetSlot() const { return slot; }
+	uint32_t GetGeneration() const { return generation; }
+
+	/// Generation in the high half, slot in the low half.
+	uint64_t Pack() const { return (static_cast<uint64_t>(generation) << 32) | slot; }
+	/// Rebuilds a packed reference. For T other than Instance, a live instance that is not a T gives an
+	/// empty reference, so values coming from scripts or the network can be trusted once unpacked.
+	static InstanceRef Unpack(uint64_t packed) {
+		InstanceRef ref;
+		ref.slot = static_cast<uint32_t>(packed);
+		ref.generation = static_cast<uint32_t>(packed >> 32);
+		if constexpr (!std::is_same_v<T, Instance>) {
+			Instance* instance = GetInstanceSlots().Resolve(ref.slot, ref.generation);
+			if (instance && !Reflection::InstanceIsA(instance, &T::StaticClass())) {
+				return InstanceRef();
+			}
+		}
+		return ref;
+	}
+
+private:
+	uint32_t slot = 0;
+	uint32_t generation = 0;
+};
+
+static_assert(sizeof(InstanceRef<>) == sizeof(uint64_t));
@@ -1,23 +1,88 @@
 #include "Instance/ObjectInstance.h"
 #include "Instance/World.h"
 
+namespace {
+    //Objects outside of any world keep their transforms here until they are parented into one.
+    //Never destroyed, since objects may be released after static destruction has begun.
+    TransformStore& detachedTransforms() {
+        static TransformStore* store = new TransformStore();
+        return *store;
+    }
+
+    //Moves the objects below root into world. Objects under a nested World belong to that one instead.
+    void propagateWorld(Instance* root, World* world) {
+        root->ForEachLoadedDescendant([&](Instance* descendant) {
+            if (descendant->IsA<World>()) {
+                return TraversalAction::SkipChildren;
+            }
+            if (descendant->IsA<ObjectInstance>()) {
+                static_cast<ObjectInstance*>(descendant)->UpdateWorld(world);
+            }
+            return TraversalAction::Continue;
+        });
+    }
+}
+
+ObjectInstance::ObjectInstance(Engine* engine) : Instance(engine) {
+    transformHandle = detachedTransforms().Allocate(this);
+}
+
+ObjectInstance::~ObjectInstance() {
+    GetTransformStore().Release(transformHandle);
+}
+
+Math::Transform<double> ObjectInstance::GetWorldTransform() const {
+    return GetTransformStore().GetTransform(transformHandle);
+}
+
+void ObjectInstance::SetWorldTransform(const Math::Transform<double>& value) {
+    GetTransformStore().SetTransform(transformHandle, value);
+    raisePropChanged(prop_WorldTransform);
+}
+
+TransformStore& ObjectInstance::GetTransformStore() const {
+    return world ? world->GetTransformStore() : detachedTransforms();
+}
+
+void ObjectInstance::UpdateWorld(World* newWorld) {
+    if (newWorld == world) {
+        return;
+    }
+    TransformStore& destination = newWorld ? newWorld->GetTransformStore() : detachedTransforms();
+    transformHandle = GetTransformStore().MoveTo(transformHandle, destination);
+    world = newWorld;
+}
+
+World* ObjectInstance::FindWorld(Instance* node) {
+    while (node && !node->IsA<World>()) {
+        node = node->Parent;
+    }
+    return static_cast<World*>(node);
+}
+
+void ObjectInstance::UpdateDescendantWorlds(Instance* root, World* oldWorld) {
+    if (root->IsA<ObjectInstance>() || root->IsA<World>()) {
+        //Objects handle their own move, and a World's descendants stay in it.
+        return;
+    }
+    World* newWorld = FindWorld(root->Parent);
+    if (newWorld != oldWorld) {
+        propagateWorld(root, newWorld);
+    }
+}
+
 void ObjectInstance::__onParentChanged(Instance* newParent) {
     World* lastWorld = world;
-    if (newParent->IsA<World>()) {
-        world = static_cast<World*>(newParent);
-    } else if (newParent->IsA<ObjectInstance>()) {
-        ObjectInstance* parentObject = static_cast<ObjectInstance*>(newParent);
-        world = parentObject->world;
+    if (newParent && newParent->IsA<ObjectInstance>()) {
+        UpdateWorld(static_cast<ObjectInstance*>(newParent)->world);
+    } else {
+        //Any Instance in between, such as a folder, still leaves the object in the world above it.
+        UpdateWorld(FindWorld(newParent));
     }
-    
+
     //if we see a change in world, let's propagate to all descendants.
+    //Unloaded ones pick their world up from their parent when they stream in.
     if (world != lastWorld) {
-        std::vector<Instance*> descendants = GetDescendants();
-        for (Instance* descendant : descendants) {
-            if (descendant->IsA<ObjectInstance>()) {
-                ObjectInstance* objDescendant = static_cast<ObjectInstance*>(descendant);
-                objDescendant->world = world;
-            }
-        }
+        propagateWorld(this, world);
     }
-}
\ No newline at end of file
+}
@@ -2,6 +2,7 @@
 
 #include "Instance/Instance.h"
 #include "Math/Transform.h"
+#include "Instance/TransformStore.h"
 #include "ObjectInstance.generated.h"
 
 class World;
@@ -10,19 +11,36 @@ class World;
 class [[reflect()]] ObjectInstance : public Instance, BaseInstance<ObjectInstance> {
 	REFLECTION()
 public:
-	ObjectInstance(Engine* engine) : Instance(engine) {}
+	ObjectInstance(Engine* engine);
+	~ObjectInstance();
 
-	[[reflect()]]
+	[[reflect(Derived)]]
 	[[summary("The object's world transform.")]]
-	Math::Transform<double> WorldTransform;
+	Math::Transform<double> GetWorldTransform() const;
+	void SetWorldTransform(const Math::Transform<double>& value);
+
+	/// The store holding this object's transform: its world's, or a shared one while outside any world.
+	TransformStore& GetTransformStore() const;
+	TransformStore::Handle GetTransformHandle() const { return transformHandle; }
 
 	[[reflect()]]
 	World* GetWorld() const { return world; }
 
+	/// Moves the object's transform into newWorld's store, or the detached one for nullptr. Does not touch
+	/// descendants. World membership follows the tree, so this is for keeping it in step, not for changing it.
+	void UpdateWorld(World* newWorld);
+	/// The nearest World at or above node, or nullptr.
+	static World* FindWorld(Instance* node);
+	/// Called by Instance after root, which is not an object, is reparented out of oldWorld: moves the objects
+	/// below it into the world root is now under. Only objects track their world, so nothing else would.
+	static void UpdateDescendantWorlds(Instance* root, World* oldWorld);
+
 protected:
-	World* world;
+	/// The nearest World ancestor, or nullptr outside of any world.
+	World* world = nullptr;
+	TransformStore::Handle transformHandle = TransformStore::InvalidHandle;
 
-	void __onParentChanged(Instance* newParent);
+	void __onParentChanged(Instance* newParent) override;
 };
 
 REFLECTION_END()
\ No newline at end of file
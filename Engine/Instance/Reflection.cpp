@@ -1,8 +1,234 @@
 #include "Instance/Reflection.h"
+#include <algorithm>
+#include <deque>
+#include <cstring>
 
 Reflection::Registry& Reflection::GetRegistry() {
     if (!registry) {
         registry = new Registry();
     }
     return *registry;
-}
\ No newline at end of file
+}
+
+namespace {
+    template<typename Fn>
+    void forEachBaseClass(Reflection::Class* cls, Fn&& fn) {
+        for (std::span<const uint64_t> bases : { cls->publicBaseClasses, cls->protectedBaseClasses, cls->privateBaseClasses }) {
+            for (uint64_t baseId : bases) {
+                Reflection::Class* baseClass = Reflection::GetRegistry().GetClassById(baseId);
+                if (baseClass) {
+                    fn(baseClass);
+                }
+            }
+        }
+    }
+
+    enum class ResolveState : uint8_t {
+        Pending,
+        Visiting,
+        Done
+    };
+
+    void resolveAncestors(Reflection::Class* cls, std::vector<ResolveState>& states) {
+        ResolveState& state = states[cls->index];
+        if (state != ResolveState::Pending) {
+            //Done, or a malformed cyclic hierarchy which we simply stop following.
+            return;
+        }
+        state = ResolveState::Visiting;
+
+        cls->ancestorBits[cls->index >> 6] |= 1ull << (cls->index & 63);
+        forEachBaseClass(cls, [&](Reflection::Class* baseClass) {
+            resolveAncestors(baseClass, states);
+            for (size_t i = 0; i < cls->ancestorBits.size(); i++) {
+                cls->ancestorBits[i] |= baseClass->ancestorBits[i];
+            }
+        });
+
+        states[cls->index] = ResolveState::Done;
+    }
+}
+
+void Reflection::Registry::Register(Class* cls) {
+    if (GetClassById(cls->id)) {
+        return;
+    }
+    auto byId = std::lower_bound(registeredById.begin(), registeredById.end(), cls->id, [](const ClassIdEntry& entry, uint64_t id) {
+        return entry.id < id;
+    });
+    registeredById.insert(byId, { cls->id, cls });
+    auto byName = std::lower_bound(registeredByName.begin(), registeredByName.end(), cls->className, [](const ClassNameEntry& entry, std::string_view name) {
+        return entry.name < name;
+    });
+    registeredByName.insert(byName, { cls->className, cls });
+}
+
+void Reflection::Registry::Finalize() {
+    //Both lists are already sorted by name, so merging them keeps indices stable from run to run.
+    classesByIndex.clear();
+    classesByIndex.reserve(generatedByName.size() + registeredByName.size());
+    size_t generated = 0;
+    size_t registered = 0;
+    while (generated < generatedByName.size() || registered < registeredByName.size()) {
+        if (registered == registeredByName.size() || (generated < generatedByName.size() && generatedByName[generated].name < registeredByName[registered].name)) {
+            classesByIndex.push_back(generatedByName[generated++].cls);
+        } else {
+            classesByIndex.push_back(registeredByName[registered++].cls);
+        }
+    }
+
+    //Everything built here lives in storage owned by the registry, so class descriptors stay trivially
+    //destructible and nothing has to be torn down at exit.
+    size_t numWords = (classesByIndex.size() + 63) / 64;
+    ancestorStorage.assign(classesByIndex.size() * numWords, 0);
+    size_t numTableProperties = 0;
+    for (size_t i = 0; i < classesByIndex.size(); i++) {
+        Class* cls = classesByIndex[i];
+        cls->index = static_cast<uint32_t>(i);
+        cls->ancestorBits = std::span<uint64_t>(ancestorStorage.data() + i * numWords, numWords);
+        numTableProperties += cls->propertyTable.properties.size();
+        for (Property& prop : cls->properties) {
+            PropertyAccessor& accessor = prop.accessor;
+            if (accessor.fieldOffset && accessor.offset == PropertyAccessor::NoOffset) {
+                accessor.offset = accessor.fieldOffset();
+            }
+        }
+    }
+
+    //Reserved up front so the spans handed out below are never invalidated by a reallocation.
+    propertyStorage.clear();
+    propertyStorage.reserve(numTableProperties);
+    std::vector<std::vector<uint64_t>> derived(classesByIndex.size());
+    std::vector<ResolveState> states(classesByIndex.size(), ResolveState::Pending);
+    for (Class* cls : classesByIndex) {
+        resolveAncestors(cls, states);
+        forEachBaseClass(cls, [&](Class* baseClass) {
+            derived[baseClass->index].push_back(cls->id);
+        });
+
+        //Done here rather than at registration, since base classes may register after their subclasses.
+        PropertyTable& table = cls->propertyTable;
+        size_t rawStart = propertyStorage.size();
+        for (Property* prop : table.properties) {
+            if (prop->accessor.IsRaw()) {
+                propertyStorage.push_back(prop);
+            }
+        }
+        size_t copyableStart = propertyStorage.size();
+        for (Property* prop : table.properties) {
+            if (!prop->accessor.IsRaw() && prop->accessor.copy && !HasFlag(prop->flags, PropFlags::ReadOnly)) {
+                propertyStorage.push_back(prop);
+            }
+        }
+        size_t derivedPropertiesStart = propertyStorage.size();
+        for (Property* prop : table.properties) {
+            if (prop->accessor.copyValue && !HasFlag(prop->flags, PropFlags::ReadOnly)) {
+                propertyStorage.push_back(prop);
+            }
+        }
+        table.rawProperties = std::span<Property* const>(propertyStorage.data() + rawStart, copyableStart - rawStart);
+        table.copyableProperties = std::span<Property* const>(propertyStorage.data() + copyableStart, derivedPropertiesStart - copyableStart);
+        table.derivedProperties = std::span<Property* const>(propertyStorage.data() + derivedPropertiesStart, propertyStorage.size() - derivedPropertiesStart);
+        std::sort(propertyStorage.begin() + rawStart, propertyStorage.begin() + copyableStart, [](const Property* a, const Property* b) {
+            return a->accessor.offset < b->accessor.offset;
+        });
+    }
+
+    derivedStorage.clear();
+    for (const std::vector<uint64_t>& ids : derived) {
+        derivedStorage.insert(derivedStorage.end(), ids.begin(), ids.end());
+    }
+    size_t derivedStart = 0;
+    for (Class* cls : classesByIndex) {
+        size_t count = derived[cls->index].size();
+        cls->derivedClasses = std::span<const uint64_t>(derivedStorage.data() + derivedStart, count);
+        derivedStart += count;
+    }
+
+    finalized = true;
+    generation++;
+}
+
+void Reflection::Class::GetAllBaseClasses(std::vector<Class*>& classes) {
+    std::deque<Class*> pending = { this };
+    while (!pending.empty()) {
+        Class* cls = pending.front();
+        pending.pop_front();
+        forEachBaseClass(cls, [&](Class* baseClass) {
+            if (std::find(classes.begin(), classes.end(), baseClass) == classes.end()) {
+                classes.push_back(baseClass);
+                pending.push_back(baseClass);
+            }
+        });
+    }
+}
+
+void Reflection::Class::GetAllDerivedClasses(std::vector<Class*>& classes) {
+    std::deque<Class*> pending = { this };
+    while (!pending.empty()) {
+        Class* cls = pending.front();
+        pending.pop_front();
+        for (uint64_t derivedId : cls->derivedClasses) {
+            Class* derivedClass = GetRegistry().GetClassById(derivedId);
+            if (derivedClass && std::find(classes.begin(), classes.end(), derivedClass) == classes.end()) {
+                classes.push_back(derivedClass);
+                pending.push_back(derivedClass);
+            }
+        }
+    }
+}
+
+namespace {
+    template<typename Pred>
+    Reflection::Property* findPropertyRecursive(Reflection::Class* cls, Pred& pred) {
+        for (Reflection::Property& prop : cls->properties) {
+            if (pred(prop)) {
+                return &prop;
+            }
+        }
+        Reflection::Property* found = nullptr;
+        forEachBaseClass(cls, [&](Reflection::Class* baseClass) {
+            if (!found) {
+                found = findPropertyRecursive(baseClass, pred);
+            }
+        });
+        return found;
+    }
+}
+
+Reflection::Property* Reflection::Class::findPropertyUnindexed(uint64_t propId) {
+    auto pred = [&](const Property& prop) { return prop.id == propId; };
+    return findPropertyRecursive(this, pred);
+}
+
+Reflection::Property* Reflection::Class::findPropertyUnindexed(std::string_view name) {
+    auto pred = [&](const Property& prop) { return prop.name == name; };
+    return findPropertyRecursive(this, pred);
+}
+
+void Reflection::Class::CopyRawProperties(const ::Instance* from, ::Instance* to, PropFlags excluded) const {
+    const std::byte* src = reinterpret_cast<const std::byte*>(from);
+    std::byte* dst = reinterpret_cast<std::byte*>(to);
+
+    //Extend the current run while fields are back to back, then copy it in one go.
+    uint32_t runStart = 0;
+    uint32_t runEnd = 0;
+    for (const Property* prop : propertyTable.rawProperties) {
+        if (HasFlag(prop->flags, excluded)) {
+            continue;
+        }
+        const PropertyAccessor& accessor = prop->accessor;
+        if (runEnd != runStart && accessor.offset == runEnd) {
+            runEnd += accessor.size;
+            continue;
+        }
+        if (runEnd != runStart) {
+            std::memcpy(dst + runStart, src + runStart, runEnd - runStart);
+        }
+        runStart = accessor.offset;
+        runEnd = accessor.offset + accessor.size;
+    }
+    if (runEnd != runStart) {
+        std::memcpy(dst + runStart, src + runStart, runEnd - runStart);
+    }
+}
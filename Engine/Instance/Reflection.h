@@ -4,22 +4,29 @@
 #include <string>
 #include <any>
 #include <string_view>
-#include <functional>
+#include <span>
 #include <cassert>
-#include <unordered_map>
 #include <exception>
 #include <stdexcept>
 #include <memory>
+#include <typeinfo>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <bit>
 #include "Core/Export.h"
 #include "Scripting/StateContext.h"
+#include "Instance/InstancePool.h"
 
 class Instance;
 class Engine;
 
 namespace Reflection {
 
+	/// Same hash the reflection generator uses for class, property, event and method ids.
 	constexpr uint64_t fnv1a64(std::string_view s) {
-		uint64_t h = 1469598103934665603ull;
+		uint64_t h = 14695981039346656037ull;
 		for (char c : s) {
 			h ^= static_cast<unsigned char>(c);
 			h *= 1099511628211ull;
@@ -27,6 +34,37 @@ namespace Reflection {
 		return h;
 	}
 
+	/// Mixes a 64-bit key with a seed. Must match mix_hash() in ReflectionGenerator/parse.py.
+	constexpr uint64_t mixHash(uint64_t key, uint64_t seed) {
+		uint64_t h = key ^ (seed * 0x9E3779B97F4A7C15ull);
+		h ^= h >> 33;
+		h *= 0xFF51AFD7ED558CCDull;
+		h ^= h >> 33;
+		h *= 0xC4CEB9FE1A85EC53ull;
+		h ^= h >> 33;
+		return h;
+	}
+
+	/// Perfect hash over a fixed set of keys, generated by the reflection generator (hash and displace).
+	/// A key picks a bucket, the bucket's seed picks the key's slot, and no two keys in the set share a slot.
+	/// Keys outside the set land on an arbitrary slot, so callers must verify what they find.
+	struct PerfectHashTable {
+		static constexpr uint16_t EmptySlot = 0xFFFF;
+
+		const uint32_t* seeds = nullptr;
+		const uint16_t* slots = nullptr;
+		uint32_t bucketMask = 0;
+		uint32_t slotMask = 0;
+
+		uint16_t Lookup(uint64_t key) const {
+			if (!slots) {
+				return EmptySlot;
+			}
+			uint32_t seed = seeds[mixHash(key, 0) & bucketMask];
+			return slots[mixHash(key, seed) & slotMask];
+		}
+	};
+
 	struct Attribute {
 		std::string key;
 		std::string value;
@@ -38,8 +76,12 @@ namespace Reflection {
 		ReadOnly = 1u << 0,
 		Hidden = 1u << 1,
 		Serializable = 1u << 2,
+		/// Saved in place files. On by default; [[reflect(Transient)]] on a property turns it off.
 		Storable = 1u << 3,
-		Replicated = 1u << 4
+		Replicated = 1u << 4,
+		/// Change notifications fire synchronously from the setter instead of going through the
+		/// engine's PropertyChangeJournal.
+		Immediate = 1u << 5
 	};
 	inline constexpr PropFlags operator| (PropFlags a, PropFlags b) {
 		return static_cast<PropFlags>(static_cast<PropFlagsType>(a) | static_cast<PropFlagsType>(b));
@@ -61,7 +103,9 @@ namespace Reflection {
 		SmartPointer = 2,
 		Vector = 3,
 		Map = 4,
-		Array = 5
+		Array = 5,
+		/// InstanceRef<T>, see Instance/InstanceRef.h.
+		InstanceRef = 6
 	};
 
 	enum class AccessLevel : uint8_t {
@@ -70,21 +114,180 @@ namespace Reflection {
 		Private = 2
 	};
 
+	/// Typed trampolines for one property, generated per property. get reads the field (or calls its getter),
+	/// set goes through the property's setter so change notifications are raised. set is null for ReadOnly properties.
+	template<typename T>
+	struct TypedAccessor {
+		T (*get)(const ::Instance* obj) = nullptr;
+		void (*set)(::Instance* obj, const T& value) = nullptr;
+	};
+
+	/// Type-erased handle to a property's TypedAccessor, plus where the field lives for direct access.
+	/// Built at compile time; the field offset is filled in by Registry::Finalize().
+	struct PropertyAccessor {
+		static constexpr uint32_t NoOffset = ~0u;
+
+		/// Byte offset of the field from the ::Instance base, or NoOffset for Derived properties.
+		uint32_t offset = NoOffset;
+		uint32_t size = 0;
+		/// The field can be read and written with memcpy. Excludes raw pointers and InstanceRefs, which refer to
+		/// other instances.
+		bool trivial = false;
+		const std::type_info* type = nullptr;
+		const void* typed = nullptr;
+		/// Copy-assigns the field of one instance from another's, bypassing the setter. Null for Derived
+		/// properties and types that are not copy-assignable.
+		void (*copy)(void* toField, const void* fromField) = nullptr;
+		/// Computes offset. Null for Derived properties.
+		uint32_t (*fieldOffset)() = nullptr;
+		/// For writable Derived properties, which have no field to copy: sets to's value to from's through the getter
+		/// and setter. Null for everything else.
+		void (*copyValue)(const PropertyAccessor& self, const ::Instance* from, ::Instance* to) = nullptr;
+		/// As copyValue, but through a buffer of size bytes, for Derived properties of a PlainValue type.
+		/// Buffers need not be aligned.
+		void (*readValue)(const PropertyAccessor& self, const ::Instance* obj, void* out) = nullptr;
+		void (*writeValue)(const PropertyAccessor& self, ::Instance* obj, const void* in) = nullptr;
+
+		/// The typed accessor, or null if the property is not of type T.
+		template<typename T>
+		const TypedAccessor<T>* As() const {
+			if (!type || *type != typeid(T)) {
+				return nullptr;
+			}
+			return static_cast<const TypedAccessor<T>*>(typed);
+		}
+
+		bool IsRaw() const { return trivial && offset != NoOffset; }
+		/// A Derived property that can still be saved as plain bytes, through readValue and writeValue.
+		bool IsDerivedRaw() const { return readValue != nullptr; }
+		/// Address of the field inside obj. Only meaningful when offset != NoOffset.
+		void* FieldPointer(::Instance* obj) const { return reinterpret_cast<std::byte*>(obj) + offset; }
+		const void* FieldPointer(const ::Instance* obj) const { return reinterpret_cast<const std::byte*>(obj) + offset; }
+	};
+
+	/// Byte offset of member from the ::Instance base of C. Used by the generated fieldOffset functions.
+	template<typename C, typename T>
+	uint32_t instanceFieldOffset(T C::* member) {
+		//Converting to a pointer to member of ::Instance rebases it onto the Instance subobject, so no object is
+		//needed. Both the Itanium and the MSVC ABI represent a data member pointer of a class without virtual bases
+		//as the member's byte offset, as a ptrdiff_t and as a 32-bit int respectively.
+		using InstanceMember = T(::Instance::*);
+		InstanceMember rebased = static_cast<InstanceMember>(member);
+		if constexpr (sizeof(InstanceMember) == sizeof(std::ptrdiff_t)) {
+			return static_cast<uint32_t>(std::bit_cast<std::ptrdiff_t>(rebased));
+		} else {
+			static_assert(sizeof(InstanceMember) == sizeof(int32_t), "unknown data member pointer representation");
+			return static_cast<uint32_t>(std::bit_cast<int32_t>(rebased));
+		}
+	}
+
+	/// Satisfied by InstanceRef<T>. Its bytes are trivially copyable but only meaningful in the running process.
+	template<typename T>
+	concept InstanceReference = T::IsInstanceReference;
+
+	/// Types whose bytes are their value: trivially copyable ones, and plain aggregates of numbers such as
+	/// Math::Transform whose hand-written copy operations only copy members.
+	template<typename T>
+	concept PlainValue = std::is_trivially_copyable_v<T> ||
+		(std::is_standard_layout_v<T> && std::is_trivially_destructible_v<T> && std::is_default_constructible_v<T>);
+
+	template<typename T>
+	constexpr PropertyAccessor MakePropertyAccessor(const TypedAccessor<T>& typed, uint32_t (*fieldOffset)() = nullptr) {
+		PropertyAccessor accessor;
+		accessor.size = static_cast<uint32_t>(sizeof(T));
+		accessor.trivial = fieldOffset != nullptr && std::is_trivially_copyable_v<T> && !std::is_pointer_v<T> && !InstanceReference<T>;
+		accessor.type = &typeid(T);
+		accessor.typed = &typed;
+		accessor.fieldOffset = fieldOffset;
+		if constexpr (std::is_copy_assignable_v<T>) {
+			if (fieldOffset != nullptr) {
+				accessor.copy = [](void* toField, const void* fromField) {
+					*static_cast<T*>(toField) = *static_cast<const T*>(fromField);
+				};
+			}
+		}
+		if (fieldOffset == nullptr && typed.set != nullptr) {
+			accessor.copyValue = [](const PropertyAccessor& self, const ::Instance* from, ::Instance* to) {
+				const TypedAccessor<T>* typed = static_cast<const TypedAccessor<T>*>(self.typed);
+				typed->set(to, typed->get(from));
+			};
+			if constexpr (PlainValue<T> && !std::is_pointer_v<T> && !InstanceReference<T>) {
+				accessor.readValue = [](const PropertyAccessor& self, const ::Instance* obj, void* out) {
+					T value = static_cast<const TypedAccessor<T>*>(self.typed)->get(obj);
+					std::memcpy(static_cast<void*>(out), static_cast<const void*>(&value), sizeof(T));
+				};
+				accessor.writeValue = [](const PropertyAccessor& self, ::Instance* obj, const void* in) {
+					T value;
+					std::memcpy(static_cast<void*>(&value), in, sizeof(T));
+					static_cast<const TypedAccessor<T>*>(self.typed)->set(obj, value);
+				};
+			}
+		}
+		return accessor;
+	}
+
+	using PropSetter = void (*)(void* obj, void* value);
+	/// Points at the property's value. For properties read through a getter this is per-thread storage, valid
+	/// until the next getter call on the same thread.
+	using PropGetter = void* (*)(void* obj);
+
 	struct Property {
-		std::string name;
-		std::string type;
+		std::string_view name;
+		std::string_view type;
 		uint64_t id;
+		/// Dense index of the property in its declaring class's propertyTable, and in that of every class derived
+		/// from it through first bases. Also the property's bit in Instance dirty bitsets.
+		uint32_t index;
 		PropFlags flags;
 		PropTypeFlags typeFlags;
 		AccessLevel accessLevel = AccessLevel::Public;
 		Lua::StateContext minimumContext = Lua::StateContext::Client;
-		void* setter = nullptr;
-		void* getter = nullptr;
+		PropSetter setter = nullptr;
+		PropGetter getter = nullptr;
+		PropertyAccessor accessor;
+	};
+
+	/// Every property visible on a class, inherited ones included, with generated perfect-hash
+	/// lookups by id and by name so a lookup never has to walk the base classes.
+	struct PropertyTable {
+		/// Base class properties first. Points into the declaring classes' property lists.
+		std::span<Property* const> properties;
+		PerfectHashTable byId;
+		/// Keyed on fnv1a64(name). A property shadowing a base property's name wins.
+		PerfectHashTable byName;
+		/// Properties whose accessor IsRaw(), sorted by field offset. Built by Registry::Finalize().
+		std::span<Property* const> rawProperties;
+		/// Writable field properties that are not raw but have an accessor copy function, such as strings
+		/// and instance references. Built by Registry::Finalize().
+		std::span<Property* const> copyableProperties;
+		/// Writable Derived properties, such as ObjectInstance::WorldTransform, which have no field and are copied
+		/// through their accessor's copyValue. Built by Registry::Finalize().
+		std::span<Property* const> derivedProperties;
+
+		Property* Find(uint64_t propId) const {
+			uint16_t i = byId.Lookup(propId);
+			if (i < properties.size() && properties[i]->id == propId) {
+				return properties[i];
+			}
+			return nullptr;
+		}
+		Property* Find(std::string_view name) const {
+			uint16_t i = byName.Lookup(fnv1a64(name));
+			if (i < properties.size() && properties[i]->name == name) {
+				return properties[i];
+			}
+			return nullptr;
+		}
+	};
+
+	struct Argument {
+		std::string_view type;
+		std::string_view name;
 	};
 
 	struct Event {
-		std::string name;
-		std::vector<std::pair<std::string, std::string>> args;
+		std::string_view name;
+		std::span<const Argument> args;
 		uint64_t id;
 		AccessLevel accessLevel = AccessLevel::Public;
 		Lua::StateContext minimumContext = Lua::StateContext::Client;
@@ -92,84 +295,121 @@ namespace Reflection {
 	};
 
 	struct Method {
-		std::string name;
-		std::string returnType;
-		std::vector<std::pair<std::string, std::string>> args;
+		std::string_view name;
+		std::string_view returnType;
+		std::span<const Argument> args;
 		uint64_t id;
 		AccessLevel accessLevel = AccessLevel::Public;
 		Lua::StateContext minimumContext = Lua::StateContext::Client;
 		//flags?
 	};
 
+	/// Generated classes are constant-initialized: the descriptor, its property, event and base class
+	/// arrays and its property table are all laid out by the compiler, so nothing runs at startup.
+	/// Only the members filled in by Registry::Finalize() are built at runtime, into storage owned by the registry.
 	struct Class {
-		std::string className;
+		std::string_view className;
 		uint64_t id;
-		std::vector<Property> properties;
-		std::vector<Event> events;
-		std::vector<Method> methods;
+		/// Properties declared on this class itself. Mutable so Registry::Finalize() can resolve field offsets.
+		std::span<Property> properties;
+		std::span<const Event> events;
+		std::span<const Method> methods;
 
-		::std::function<::Instance* (Engine*)> constructor = nullptr;
-		::std::function<::std::shared_ptr<::Instance>(Engine*)> sharedConstructor = nullptr;
+		::Instance* (*constructor)(Engine*) = nullptr;
+		::std::shared_ptr<::Instance> (*sharedConstructor)(Engine*) = nullptr;
 
-		std::vector<uint64_t> publicBaseClasses;
-		std::vector<uint64_t> protectedBaseClasses;
-		std::vector<uint64_t> privateBaseClasses;
+		std::span<const uint64_t> publicBaseClasses;
+		std::span<const uint64_t> protectedBaseClasses;
+		std::span<const uint64_t> privateBaseClasses;
 
-		std::vector<uint64_t> derivedClasses;
+		/// Built by Registry::Finalize().
+		std::span<const uint64_t> derivedClasses;
 
 		bool isInterface = false;
 
+		static constexpr uint32_t InvalidIndex = ~0u;
+		/// Dense index assigned by Registry::Finalize(); InvalidIndex until the hierarchy has been finalized.
+		uint32_t index = InvalidIndex;
+		/// Bitset over dense class indices, with a bit set for this class and every class it derives from.
+		/// Built by Registry::Finalize().
+		std::span<uint64_t> ancestorBits;
+
+		/// Returns the slab pool that Instantiate() carves instances from. Null for interfaces and abstract classes.
+		InstancePool& (*pool)() = nullptr;
+		/// Releases an instance created by Instantiate() back to this class's pool.
+		void (*destructor)(::Instance*) = nullptr;
+
+		/// Generated alongside the class. Empty for classes registered by hand.
+		PropertyTable propertyTable;
+		/// Bits of the propertyTable indices of PropFlags::Immediate properties, whose change events have already
+		/// fired by the time the journal flushes.
+		uint64_t immediateProps = 0;
+
 		/// Builds a vector of all base classes all the way up the chain, closest ancestors first.
-		void GetAllBaseClasses(std::vector<Class*>& classes) {
-			//todo: resolve the class ids to actual class pointers
-		}
+		void GetAllBaseClasses(std::vector<Class*>& classes);
 
 		/// Builds a vector of all derived classes all the way down the chain, closest descendants first.
-		void GetAllDerivedClasses(std::vector<Class*>& classes) {
-			//todo: resolve the class ids to actual class pointers
-		}
+		void GetAllDerivedClasses(std::vector<Class*>& classes);
 
-		void ResolvePropSetter(uint64_t propId, void* setter) {
-			for (auto& prop : properties) {
-				if (prop.id == propId) {
-					prop.setter = setter;
-					return;
-				}
-			}
-		}
-		void ResolvePropGetter(uint64_t propId, void* getter) {
-			for (auto& prop : properties) {
-				if (prop.id == propId) {
-					prop.getter = getter;
-					return;
-				}
-			}
+		/// Finds a property declared on this class or inherited from a base class. Null if there is none.
+		Property* FindProperty(uint64_t propId);
+		Property* FindProperty(std::string_view name);
+		/// Linear search through this class and its bases, for classes without a generated property table.
+		Property* findPropertyUnindexed(uint64_t propId);
+		Property* findPropertyUnindexed(std::string_view name);
+
+		/// The typed accessor for a property, or null if there is no such property or it is not of type T.
+		template<typename T>
+		const TypedAccessor<T>* GetAccessor(uint64_t propId) {
+			Property* prop = FindProperty(propId);
+			return prop ? prop->accessor.template As<T>() : nullptr;
 		}
 
-		const ::std::string& GetPropName(uint64_t propId) {
-			for (auto& prop : properties) {
-				if (prop.id == propId) {
-					return prop.name;
-				}
+		/// Copies every trivially copyable field property, inherited ones included, from one instance of this class
+		/// to another with memcpy, merging adjacent fields into a single copy. Setters are bypassed and no change
+		/// notifications are raised. Properties carrying any of the excluded flags are left alone.
+		void GP_EXPORT CopyRawProperties(const ::Instance* from, ::Instance* to, PropFlags excluded = PropFlags::ReadOnly) const;
+
+		std::string_view GetPropName(uint64_t propId) {
+			Property* prop = FindProperty(propId);
+			if (prop) {
+				return prop->name;
 			}
 			throw std::runtime_error("Invalid property id given to Class::getPropName()!");
 		}
 
 		bool IsA(std::string_view className);
 		bool IsA(uint64_t classId);
+		bool IsA(const Class* other) const;
 
 		Instance* Instantiate(Engine* engine) {
 			if (isInterface) {
-				throw std::runtime_error("Cannot instantiate an interface class: " + className);
+				throw std::runtime_error("Cannot instantiate an interface class: " + std::string(className));
 			}
 			if (constructor) {
 				return constructor(engine);
 			}
 			return nullptr;
 		}
+		/// Destroys an instance previously returned by Instantiate(). Must be called on the instance's most derived class.
+		void Destroy(Instance* inst) {
+			if (!inst) return;
+			if (!destructor) {
+				throw std::runtime_error("Cannot destroy an instance of class " + std::string(className) + ": no destructor registered!");
+			}
+			destructor(inst);
+		}
+
+		InstancePoolStats GetPoolStats() const {
+			if (pool) {
+				return pool().GetStats();
+			}
+			return InstancePoolStats();
+		}
+
 		std::shared_ptr<Instance> InstantiateShared(Engine* engine) {
 			if (isInterface) {
-				throw std::runtime_error("Cannot instantiate an interface class: " + className);
+				throw std::runtime_error("Cannot instantiate an interface class: " + std::string(className));
 			}
 			if (sharedConstructor) {
 				return sharedConstructor(engine);
@@ -179,8 +419,8 @@ namespace Reflection {
 
 		template<typename T>
 		T* InstantiateAs(Engine* engine) {
-			if (!IsA(T::StaticClass().id)) {
-				throw std::runtime_error("Cannot instantiate class " + className + " as " + T::StaticClass().className + "!");
+			if (!IsA(&T::StaticClass())) {
+				throw std::runtime_error("Cannot instantiate class " + std::string(className) + " as " + std::string(T::StaticClass().className) + "!");
 			}
 
 			Instance* inst = Instantiate(engine);
@@ -191,8 +431,8 @@ namespace Reflection {
 		}
 		template<typename T>
 		std::shared_ptr<T> InstantiateSharedAs(Engine* engine) {
-			if (!IsA(T::StaticClass().id)) {
-				throw std::runtime_error("Cannot instantiate class " + className + " as " + T::StaticClass().className + "!");
+			if (!IsA(&T::StaticClass())) {
+				throw std::runtime_error("Cannot instantiate class " + std::string(className) + " as " + std::string(T::StaticClass().className) + "!");
 			}
 			std::shared_ptr<Instance> inst = InstantiateShared(engine);
 			if (inst) {
@@ -202,36 +442,124 @@ namespace Reflection {
 		}
 	};
 
+	struct ClassIdEntry {
+		uint64_t id;
+		Class* cls;
+	};
+	struct ClassNameEntry {
+		std::string_view name;
+		Class* cls;
+	};
+
 	struct Registry {
-		::std::unordered_map<::std::string_view, Class*> classes;
-		::std::unordered_map<uint64_t, Class*> classesById;
+		/// Classes ordered by their dense index, which is their order by name. Only valid once Finalize() has run.
+		::std::vector<Class*> classesByIndex;
 
-		Class* GetClass(std::string_view className) {
-			auto it = classes.find(className);
-			if (it != classes.end()) {
-				return it->second;
-			}
-			return nullptr;
+		/// Points the registry at the generated class tables, which the generator emits already sorted
+		/// by id and by name. Nothing is copied.
+		void Install(std::span<const ClassIdEntry> byId, std::span<const ClassNameEntry> byName) {
+			generatedById = byId;
+			generatedByName = byName;
+		}
+		/// Adds a class that is not in the generated tables, such as one registered by hand.
+		/// Does nothing if a class with the same id is already known.
+		void GP_EXPORT Register(Class* cls);
+
+		Class* GetClass(std::string_view className) const {
+			Class* cls = findSorted(generatedByName, className, &ClassNameEntry::name);
+			return cls ? cls : findSorted(std::span<const ClassNameEntry>(registeredByName), className, &ClassNameEntry::name);
+		}
+		Class* GetClassById(uint64_t classId) const {
+			Class* cls = findSorted(generatedById, classId, &ClassIdEntry::id);
+			return cls ? cls : findSorted(std::span<const ClassIdEntry>(registeredById), classId, &ClassIdEntry::id);
 		}
-		Class* GetClassById(uint64_t classId) {
-			auto it = classesById.find(classId);
-			if (it != classesById.end()) {
-				return it->second;
+		Class* GetClassByIndex(uint32_t index) const {
+			return index < classesByIndex.size() ? classesByIndex[index] : nullptr;
+		}
+		/// Every class, in dense index order. Only valid once Finalize() has run.
+		std::span<Class* const> GetClasses() const { return classesByIndex; }
+
+		/// Flattens the registered class hierarchy into dense class indices and per-class ancestor bitsets,
+		/// turning Class::IsA into a bit test, and resolves property field offsets. Called at the end of
+		/// registerAllClasses(); safe to call again if more classes are registered later.
+		void GP_EXPORT Finalize();
+		bool IsFinalized() const { return finalized; }
+		/// Incremented by every Finalize(), so caches keyed on dense class indices can detect reindexing.
+		uint32_t GetGeneration() const { return generation; }
+
+	private:
+		std::span<const ClassIdEntry> generatedById;
+		std::span<const ClassNameEntry> generatedByName;
+		std::vector<ClassIdEntry> registeredById;
+		std::vector<ClassNameEntry> registeredByName;
+		/// Backing storage for the Class and PropertyTable members built by Finalize().
+		std::vector<uint64_t> ancestorStorage;
+		std::vector<uint64_t> derivedStorage;
+		std::vector<Property*> propertyStorage;
+		bool finalized = false;
+		uint32_t generation = 0;
+
+		template<typename Entry, typename Key>
+		static Class* findSorted(std::span<const Entry> entries, const Key& key, Key Entry::* field) {
+			size_t lo = 0;
+			size_t hi = entries.size();
+			while (lo < hi) {
+				size_t mid = (lo + hi) / 2;
+				if (entries[mid].*field < key) {
+					lo = mid + 1;
+				} else {
+					hi = mid;
+				}
 			}
-			return nullptr;
+			return (lo < entries.size() && entries[lo].*field == key) ? entries[lo].cls : nullptr;
 		}
 	};
 
-	inline static Registry* registry;
+	inline Registry* registry = nullptr;
 	Registry& GP_EXPORT GetRegistry();
 
-	void TrySetClass(Instance* obj, Class* cls);
-	inline void TrySetClass(...) {}
+	inline bool Class::IsA(const Class* other) const {
+		if (!other) {
+			return false;
+		}
+		if (other == this) {
+			return true;
+		}
+		if (index != InvalidIndex && other->index != InvalidIndex) {
+			uint32_t word = other->index >> 6;
+			return word < ancestorBits.size() && ((ancestorBits[word] >> (other->index & 63)) & 1) != 0;
+		}
+		//hierarchy not finalized yet, walk the base lists instead.
+		return const_cast<Class*>(this)->IsA(other->id);
+	}
+
+	inline Property* Class::FindProperty(uint64_t propId) {
+		if (propertyTable.byId.slots) {
+			return propertyTable.Find(propId);
+		}
+		return findPropertyUnindexed(propId);
+	}
+
+	inline Property* Class::FindProperty(std::string_view name) {
+		if (propertyTable.byName.slots) {
+			return propertyTable.Find(name);
+		}
+		return findPropertyUnindexed(name);
+	}
 
 	inline bool Class::IsA(std::string_view className) {
 		if (this->className == className) {
 			return true;
 		}
+		if (index != InvalidIndex) {
+			Class* other = Reflection::GetRegistry().GetClass(className);
+			if (!other) {
+				return false;
+			}
+			if (other->index != InvalidIndex) {
+				return IsA(other);
+			}
+		}
 		//check base classes
 		for (uint64_t baseId : publicBaseClasses) {
 			Class* baseClass = Reflection::GetRegistry().GetClassById(baseId);
@@ -258,6 +586,15 @@ namespace Reflection {
 		if (this->id == classId) {
 			return true;
 		}
+		if (index != InvalidIndex) {
+			Class* other = Reflection::GetRegistry().GetClassById(classId);
+			if (!other) {
+				return false;
+			}
+			if (other->index != InvalidIndex) {
+				return IsA(other);
+			}
+		}
 		//check base classes
 		for (uint64_t baseId : publicBaseClasses) {
 			Class* baseClass = Reflection::GetRegistry().GetClassById(baseId);
@@ -10,11 +10,14 @@ class [[reflect()]] System : public Instance, BaseInstance<System> {
 public:
 	System(Engine* engine);
 
-	void Register(SystemInitOrder& initOrder);
-	void Initialize();
-	void Shutdown();
+	/// Declares ordering and data access, see SystemInitOrder. Systems that declare no access are updated
+	/// on the thread calling Engine::Update(), one at a time.
+	virtual void Register(SystemInitOrder& initOrder);
+	virtual void Initialize();
+	virtual void Shutdown();
 
-	void Update(double deltaTime);
+	/// Called once per Engine::Update(), possibly on a worker thread if the system declared its access.
+	virtual void Update(double deltaTime);
 };
 
 REFLECTION_END()
\ No newline at end of file
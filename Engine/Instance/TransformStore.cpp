@@ -0,0 +1,142 @@
+#include "Instance/TransformStore.h"
+#include <cmath>
+
+TransformStore::Handle TransformStore::Allocate(ObjectInstance* owner, const Math::Transform<double>& transform) {
+	version++;
+	Handle handle;
+	if (!freeHandles.empty()) {
+		handle = freeHandles.back();
+		freeHandles.pop_back();
+	} else {
+		handle = static_cast<Handle>(denseIndices.size());
+		denseIndices.push_back(0);
+	}
+	size_t index = owners.size();
+	denseIndices[handle] = static_cast<uint32_t>(index);
+	owners.push_back(owner);
+	handles.push_back(handle);
+	for (std::vector<double>& component : components) {
+		component.push_back(0.0);
+	}
+	write(index, transform);
+	return handle;
+}
+
+void TransformStore::Release(Handle handle) {
+	version++;
+	size_t index = denseIndices[handle];
+	size_t last = owners.size() - 1;
+	if (index != last) {
+		for (std::vector<double>& component : components) {
+			component[index] = component[last];
+		}
+		owners[index] = owners[last];
+		handles[index] = handles[last];
+		denseIndices[handles[index]] = static_cast<uint32_t>(index);
+	}
+	for (std::vector<double>& component : components) {
+		component.pop_back();
+	}
+	owners.pop_back();
+	handles.pop_back();
+	freeHandles.push_back(handle);
+}
+
+TransformStore::Handle TransformStore::MoveTo(Handle handle, TransformStore& destination) {
+	size_t index = denseIndices[handle];
+	Handle moved = destination.Allocate(owners[index]);
+	size_t destinationIndex = destination.denseIndices[moved];
+	for (size_t i = 0; i < ComponentCount; i++) {
+		destination.components[i][destinationIndex] = components[i][index];
+	}
+	Release(handle);
+	return moved;
+}
+
+Math::Transform<double> TransformStore::GetTransform(Handle handle) const {
+	size_t index = denseIndices[handle];
+	Math::Transform<double> result;
+	result.SetRotation(Math::Quaternion<double>(components[RotationX][index], components[RotationY][index], components[RotationZ][index], components[RotationW][index]));
+	//Scale applies before rotation, so it scales the basis columns.
+	double scale[3] = { components[ScaleX][index], components[ScaleY][index], components[ScaleZ][index] };
+	for (int column = 0; column < 3; column++) {
+		for (int row = 0; row < 3; row++) {
+			result.m[column][row] *= scale[column];
+		}
+	}
+	result.SetTranslation(Math::Vector3<double>(components[PositionX][index], components[PositionY][index], components[PositionZ][index]));
+	return result;
+}
+
+void TransformStore::SetTransform(Handle handle, const Math::Transform<double>& transform) {
+	version++;
+	write(denseIndices[handle], transform);
+}
+
+Math::Vector3<double> TransformStore::GetPosition(Handle handle) const {
+	size_t index = denseIndices[handle];
+	return Math::Vector3<double>(components[PositionX][index], components[PositionY][index], components[PositionZ][index]);
+}
+
+void TransformStore::SetPosition(Handle handle, const Math::Vector3<double>& position) {
+	version++;
+	size_t index = denseIndices[handle];
+	components[PositionX][index] = position.X;
+	components[PositionY][index] = position.Y;
+	components[PositionZ][index] = position.Z;
+}
+
+Math::Quaternion<double> TransformStore::GetRotation(Handle handle) const {
+	size_t index = denseIndices[handle];
+	return Math::Quaternion<double>(components[RotationX][index], components[RotationY][index], components[RotationZ][index], components[RotationW][index]);
+}
+
+void TransformStore::SetRotation(Handle handle, const Math::Quaternion<double>& rotation) {
+	version++;
+	size_t index = denseIndices[handle];
+	components[RotationX][index] = rotation.X;
+	components[RotationY][index] = rotation.Y;
+	components[RotationZ][index] = rotation.Z;
+	components[RotationW][index] = rotation.W;
+}
+
+Math::Vector3<double> TransformStore::GetScale(Handle handle) const {
+	size_t index = denseIndices[handle];
+	return Math::Vector3<double>(components[ScaleX][index], components[ScaleY][index], components[ScaleZ][index]);
+}
+
+void TransformStore::SetScale(Handle handle, const Math::Vector3<double>& scale) {
+	version++;
+	size_t index = denseIndices[handle];
+	components[ScaleX][index] = scale.X;
+	components[ScaleY][index] = scale.Y;
+	components[ScaleZ][index] = scale.Z;
+}
+
+void TransformStore::write(size_t index, const Math::Transform<double>& transform) {
+	components[PositionX][index] = transform.m03;
+	components[PositionY][index] = transform.m13;
+	components[PositionZ][index] = transform.m23;
+
+	//The basis column lengths are the scale, what is left once they are normalized is the rotation.
+	Math::Transform<double> basis = transform;
+	double scale[3];
+	for (int column = 0; column < 3; column++) {
+		double* axis = basis.m[column];
+		scale[column] = std::sqrt(axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2]);
+		if (scale[column] != 0.0) {
+			axis[0] /= scale[column];
+			axis[1] /= scale[column];
+			axis[2] /= scale[column];
+		}
+	}
+	components[ScaleX][index] = scale[0];
+	components[ScaleY][index] = scale[1];
+	components[ScaleZ][index] = scale[2];
+
+	Math::Quaternion<double> rotation = basis.GetRotation();
+	components[RotationX][index] = rotation.X;
+	components[RotationY][index] = rotation.Y;
+	components[RotationZ][index] = rotation.Z;
+	components[RotationW][index] = rotation.W;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include "Core/Export.h"
+#include "Math/Transform.h"
+
+class ObjectInstance;
+
+/// Structure-of-arrays storage for object transforms, owned by a World.
+/// Each transform is kept as translation, rotation and scale, one contiguous array of doubles per
+/// component, so bulk systems (physics, culling, replication) can run tight vectorizable loops over
+/// every object instead of walking the instance tree. Entries are addressed by a stable Handle;
+/// the arrays themselves stay dense, removals move the last entry into the freed position.
+/// Not thread-safe. A system that declares any access must also declare Reads or Writes of the
+/// "TransformStore" resource to touch a store, so the SystemScheduler never runs a writer beside
+/// another user; everything else only uses it from the thread calling Engine::Update().
+class GP_EXPORT TransformStore {
+public:
+	using Handle = uint32_t;
+	static constexpr Handle InvalidHandle = UINT32_MAX;
+
+	enum Component : size_t {
+		PositionX, PositionY, PositionZ,
+		RotationX, RotationY, RotationZ, RotationW,
+		ScaleX, ScaleY, ScaleZ,
+		ComponentCount
+	};
+
+	TransformStore() = default;
+	TransformStore(const TransformStore&) = delete;
+	TransformStore& operator=(const TransformStore&) = delete;
+
+	Handle Allocate(ObjectInstance* owner, const Math::Transform<double>& transform = Math::Transform<double>());
+	void Release(Handle handle);
+	/// Moves an entry into another store, keeping its value, and returns its handle there.
+	Handle MoveTo(Handle handle, TransformStore& destination);
+
+	/// Composes the matrix for an entry. Shear in a matrix passed to SetTransform is not kept.
+	Math::Transform<double> GetTransform(Handle handle) const;
+	void SetTransform(Handle handle, const Math::Transform<double>& transform);
+
+	Math::Vector3<double> GetPosition(Handle handle) const;
+	void SetPosition(Handle handle, const Math::Vector3<double>& position);
+	Math::Quaternion<double> GetRotation(Handle handle) const;
+	void SetRotation(Handle handle, const Math::Quaternion<double>& rotation);
+	Math::Vector3<double> GetScale(Handle handle) const;
+	void SetScale(Handle handle, const Math::Vector3<double>& scale);
+
+	size_t GetCount() const { return owners.size(); }
+	/// Position of an entry in the component arrays. Only valid until the next Allocate or Release.
+	size_t GetIndex(Handle handle) const { return denseIndices[handle]; }
+
+	/// One value per entry, in the same order as GetOwners(). Writing through these does not raise
+	/// ObjectInstance::WorldTransform change events; use ObjectInstance::SetWorldTransform for that.
+	/// Counts as a modification for GetVersion(), whether or not anything is written.
+	std::span<double> GetComponent(Component component) { version++; return components[component]; }
+	std::span<const double> GetComponent(Component component) const { return components[component]; }
+	std::span<ObjectInstance* const> GetOwners() const { return owners; }
+
+	/// Changes whenever an entry is added, removed or may have been written, so readers such as
+	/// SnapshotPublisher can tell an untouched store from a modified one without comparing it.
+	uint64_t GetVersion() const { return version; }
+
+private:
+	std::vector<double> components[ComponentCount];
+	std::vector<ObjectInstance*> owners;
+	/// Handle of the entry at each dense index.
+	std::vector<Handle> handles;
+	/// Dense index of each handle. Entries for released handles are stale until the handle is reused.
+	std::vector<uint32_t> denseIndices;
+	std::vector<Handle> freeHandles;
+	uint64_t version = 0;
+
+	void write(size_t index, const Math::Transform<double>& transform);
+};
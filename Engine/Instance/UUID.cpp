@@ -0,0 +1,54 @@
+#include "Instance/UUID.h"
+#include "Math/pcg/pcg_random.hpp"
+#include <chrono>
+#include <random>
+
+namespace {
+	struct UUIDGenerator {
+		pcg64 random;
+		uint64_t lastMs = 0;
+		uint32_t counter = 0;
+
+		UUIDGenerator() : random(pcg_extras::seed_seq_from<std::random_device>()) {}
+	};
+
+	constexpr uint32_t CounterBits = 12;
+	constexpr uint32_t CounterMask = (1u << CounterBits) - 1;
+}
+
+void EngineUUID::generateV7(uint8_t* out) {
+	thread_local UUIDGenerator generator;
+
+	using namespace std::chrono;
+	uint64_t ms = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
+	uint64_t random = generator.random();
+
+	if (ms > generator.lastMs) {
+		generator.lastMs = ms;
+		//Start each millisecond at a random point in the lower half, leaving at least 2048 increments.
+		generator.counter = static_cast<uint32_t>(generator.random() >> 53);
+	} else if (++generator.counter > CounterMask) {
+		//Out of counter (or the clock went backwards): borrow the next millisecond rather than repeat an id.
+		generator.lastMs++;
+		generator.counter = 0;
+	}
+	ms = generator.lastMs;
+	uint32_t counter = generator.counter;
+
+	out[0] = static_cast<uint8_t>((ms >> 40) & 0xFF);
+	out[1] = static_cast<uint8_t>((ms >> 32) & 0xFF);
+	out[2] = static_cast<uint8_t>((ms >> 24) & 0xFF);
+	out[3] = static_cast<uint8_t>((ms >> 16) & 0xFF);
+	out[4] = static_cast<uint8_t>((ms >> 8) & 0xFF);
+	out[5] = static_cast<uint8_t>((ms >> 0) & 0xFF);
+
+	out[6] = static_cast<uint8_t>(0x70 | (counter >> 8)); // Version 7 UUID
+	out[7] = static_cast<uint8_t>(counter & 0xFF);
+
+	out[8] = static_cast<uint8_t>(0x80 | (random & 0x3F)); // Variant 1 UUID
+	random >>= 6;
+	for (int i = 9; i < SIZE; ++i) {
+		out[i] = static_cast<uint8_t>(random & 0xFF);
+		random >>= 8;
+	}
+}
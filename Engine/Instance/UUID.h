@@ -1,52 +1,21 @@
 #pragma once
 #include <array>
 #include <cstdint>
-#include <random>
 #include <string>
 #include <cstdio>
-#include <chrono>
+#include <cstring>
 #include <functional>
+#include "Core/Export.h"
 
-struct EngineUUID {
+struct GP_EXPORT EngineUUID {
 	static const int SIZE = 16; // UUID size in bytes
 
 	uint8_t bytes[SIZE];
+	/// Generates a new UUIDv7: the Unix time in milliseconds, then a 12-bit counter that keeps ids from one
+	/// thread strictly increasing within a millisecond, then 62 random bits. Each thread draws from its own
+	/// PCG generator, seeded once from std::random_device, so generating an id takes no locks or syscalls.
 	EngineUUID() {
-		using namespace std::chrono;
-
-		const std::uint64_t ms = duration_cast<milliseconds>(system_clock::now().time_since_epoch()).count();
-
-		std::random_device device;
-		std::mt19937_64 generator((static_cast<std::uint64_t>(device()) << 32) ^ device());
-		std::uniform_int_distribution<std::uint64_t> distribution;
-		std::uint64_t randomA = distribution(generator);
-		std::uint64_t randomB = distribution(generator);
-
-		bytes[0] = static_cast<uint8_t>((ms >> 40) & 0xFF);
-		bytes[1] = static_cast<uint8_t>((ms >> 32) & 0xFF);
-		bytes[2] = static_cast<uint8_t>((ms >> 24) & 0xFF);
-		bytes[3] = static_cast<uint8_t>((ms >> 16) & 0xFF);
-		bytes[4] = static_cast<uint8_t>((ms >> 8) & 0xFF);
-		bytes[5] = static_cast<uint8_t>((ms >> 0) & 0xFF);
-
-		bytes[6] = static_cast<uint8_t>(0x70 | (randomA & 0x0F)); // Version 7 UUID
-		randomA >>= 4;
-
-		bytes[7] = static_cast<uint8_t>(randomA & 0xFF);
-		randomA >>= 8;
-
-		bytes[8] = static_cast<uint8_t>(0x80 | (randomB & 0x3F)); // Variant 1 UUID
-		randomA >>= 6;
-
-		for (int i = 9; i < SIZE; ++i) {
-			if (randomA) {
-				bytes[i] = static_cast<std::uint8_t>(randomA & 0xFF);
-				randomA >>= 8;
-			} else {
-				bytes[i] = static_cast<std::uint8_t>(randomB & 0xFF);
-				randomB >>= 8;
-			}
-		}
+		generateV7(bytes);
 	}
 	EngineUUID(const uint8_t* data) {
 		for (int i = 0; i < SIZE; ++i) {
@@ -70,6 +39,21 @@ struct EngineUUID {
 		return !(*this == other);
 	}
 
+	/// 64-bit hash of all 16 bytes: the two halves are folded together, then run through the
+	/// murmur3 finalizer so every input bit reaches every output bit.
+	uint64_t Hash() const {
+		uint64_t lo, hi;
+		std::memcpy(&lo, bytes, sizeof(lo));
+		std::memcpy(&hi, bytes + sizeof(lo), sizeof(hi));
+		uint64_t h = lo ^ (hi * 0x9E3779B97F4A7C15ULL);
+		h ^= h >> 33;
+		h *= 0xFF51AFD7ED558CCDULL;
+		h ^= h >> 33;
+		h *= 0xC4CEB9FE1A85EC53ULL;
+		h ^= h >> 33;
+		return h;
+	}
+
 	//Convert UUID to UTF-8 string
 	std::string ToString() const {
 		char buffer[37];
@@ -82,6 +66,9 @@ struct EngineUUID {
 			bytes[10], bytes[11], bytes[12], bytes[13], bytes[14], bytes[15]);
 		return std::string(buffer);
 	}
+
+private:
+	static void generateV7(uint8_t* out);
 };
 
 using uuid_bytes = std::array<std::uint8_t, 16>;
@@ -89,14 +76,7 @@ using uuid_bytes = std::array<std::uint8_t, 16>;
 namespace std {
 	template<> struct hash<EngineUUID> {
 		size_t operator()(const EngineUUID& uuid) const {
-			size_t hash = 0;
-			// FNV-1a hash
-			hash = 14695981039346656037ULL;
-			for (int i = 0; i < EngineUUID::SIZE; ++i) {
-				hash ^= uuid.bytes[i];
-				hash *= 1099511628211ULL;
-			}
-			return hash;
+			return static_cast<size_t>(uuid.Hash());
 		}
 	};
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Instance/Instance.h"
+#include "Instance/TransformStore.h"
 #include "World.generated.h"
 
 class [[reflect()]] World : public Instance, BaseInstance<World> {
@@ -8,7 +9,12 @@ class [[reflect()]] World : public Instance, BaseInstance<World> {
 public:
 	World(Engine* engine) : Instance(engine) {}
 
-	
+	/// Transforms of every ObjectInstance in this world.
+	TransformStore& GetTransformStore() { return transforms; }
+	const TransformStore& GetTransformStore() const { return transforms; }
+
+private:
+	TransformStore transforms;
 };
  
 REFLECTION_END()
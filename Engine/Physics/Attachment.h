@@ -15,10 +15,6 @@ public:
     [[reflect(Derived)]]
     [[summary("The secondary axis of the attachment. This corresponds to the up vector of the attachment's transform.")]]
     Math::Vector3<double> GetSecondaryAxis() const;
-
-    [[reflect(Derived)]]
-    [[summary("The world transform of the attachment.")]]
-    Math::Transform<double> GetWorldTransform() const;
 protected:
 
 
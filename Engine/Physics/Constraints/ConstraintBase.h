@@ -3,15 +3,17 @@
 #include "Instance/Instance.h"
 #include "ConstraintBase.generated.h"
 
+class Attachment;
+
 class [[reflect()]] ConstraintBase : public Instance, BaseInstance<ConstraintBase> {
     REFLECTION()
 public:
     ConstraintBase(Engine* engine) : Instance(engine) {}
 
     [[reflect()]]
-    Attachment* Attachment0 = nullptr;
+    InstanceRef<Attachment> Attachment0;
     [[reflect()]]
-    Attachment* Attachment1 = nullptr;
+    InstanceRef<Attachment> Attachment1;
     
 };
 
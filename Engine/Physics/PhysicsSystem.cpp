@@ -1,6 +1,15 @@
 #include "Physics/PhysicsSystem.h"
+#include "Core/SystemScheduler.h"
+#include "Instance/ObjectInstance.h"
 #include <algorithm>
 
+void PhysicsSystem::Register(SystemInitOrder& initOrder) {
+    //Steps bodies and writes back their transforms, nothing else, so it can run beside other systems.
+    //Transforms live in the World's TransformStore rather than on the instances, so the store is declared too.
+    initOrder.Writes<ObjectInstance>(this);
+    initOrder.Writes(this, "TransformStore");
+}
+
 void PhysicsSystem::Update(double deltaTime) {
     // Physics simulation step would go here
 }
\ No newline at end of file
@@ -9,7 +9,10 @@
 class [[reflect()]] PhysicsSystem : public System, BaseInstance<PhysicsSystem> {
 	REFLECTION()
 public:
-    PhysicsSystem(Engine* engine) : System(engine) {}    void Update(double deltaTime) override;
+    PhysicsSystem(Engine* engine) : System(engine) {}
+
+    void Register(SystemInitOrder& initOrder) override;
+    void Update(double deltaTime) override;
 
 protected:
 };
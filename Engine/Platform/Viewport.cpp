@@ -13,10 +13,7 @@ Viewport::Viewport(Engine* engine) : Instance(engine) {
 Viewport::~Viewport() {
     engine->unregisterViewport(this);
 
-    if (windowResizedListener) {
-        windowResizedListener->Disconnect();
-        windowResizedListener = nullptr;
-    }
+    windowResizedConnection.Disconnect();
     if (attachedWindow) {
         // Renderer shutdown handled by Engine/Renderer
     }
@@ -30,7 +27,7 @@ void Viewport::AttachToWindow(PlatformWindow* window) {
 
     Math::Rect<int> windowInternalBounds = attachedWindow->GetInternalBounds();
 
-    windowResizedListener = &attachedWindow->Resized.Connect([this]() {
+    windowResizedConnection = attachedWindow->Resized.Connect([this]() {
         Math::Rect<int> newBounds = attachedWindow->GetInternalBounds();
         engine->GetRenderer()->OnViewportResized(this, newBounds.Size());
         //std::cout << "Viewport resized to " << newBounds.Size().X << "x" << newBounds.Size().Y << std::endl;
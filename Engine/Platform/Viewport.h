@@ -51,7 +51,7 @@ protected:
     std::vector<IRenderable*> renderables;
     std::vector<IInputConsumer*> inputConsumers;
 
-    MulticastEvent<>::Listener* windowResizedListener = nullptr;
+    MulticastEvent<>::Connection windowResizedConnection;
 };
 
 REFLECTION_END()
\ No newline at end of file
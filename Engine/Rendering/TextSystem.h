@@ -13,11 +13,11 @@ class [[reflect()]] TextSystem : public System, BaseInstance<TextSystem> {
 public:
     TextSystem(Engine* engine);
 
-    void Register(SystemInitOrder& initOrder) {
+    void Register(SystemInitOrder& initOrder) override {
         initOrder.After(this, "AssetSystem");
     }
-    void Initialize();
-    void Shutdown();
+    void Initialize() override;
+    void Shutdown() override;
 
     void LoadFontFamily(const std::string& uri);
 
@@ -2,19 +2,17 @@
 
 #include "Instance/Instance.h"
 #include "Instance/UUID.h"
-#include <unordered_map>
 #include "Replicator.generated.h"
 
+class NetworkPeer;
+
 class [[reflect(Hidden)]] Replicator : public Instance, BaseInstance<Replicator> {
 	REFLECTION()
 public:
 	Replicator(Engine* engine) : Instance(engine) {}
 
 	[[reflect(ReadOnly)]]
-	NetworkPeer* TargetPeer;
-
-protected:
-	std::unordered_map<EngineUUID, Instance*> knownInstances;
+	InstanceRef<NetworkPeer> TargetPeer;
 };
 
 REFLECTION_END()
\ No newline at end of file
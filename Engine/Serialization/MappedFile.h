@@ -0,0 +1,34 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include "Core/Export.h"
+
+/// Read-only memory mapping of a whole file. The mapping lives as long as the object.
+class GP_EXPORT MappedFile {
+public:
+    MappedFile() = default;
+    /// Throws std::runtime_error if the file cannot be opened or mapped.
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::byte* GetData() const { return data; }
+    size_t GetSize() const { return size; }
+    bool IsOpen() const { return data != nullptr; }
+
+    void Close();
+
+private:
+    const std::byte* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#else
+    int fileDescriptor = -1;
+#endif
+};
@@ -0,0 +1,590 @@
+#include "Serialization/PlaceFile.h"
+#include "Instance/Instance.h"
+#include "Core/Engine.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <typeinfo>
+#include <unordered_map>
+
+using namespace PlaceFormat;
+
+namespace {
+    /// How a property is stored, or false if it is not stored at all. Shared by the writer and the reader,
+    /// so a column is only ever applied to a property the loading build would have written the same way.
+    bool getEncoding(const Reflection::Property& prop, Encoding& encoding) {
+        const Reflection::PropertyAccessor& accessor = prop.accessor;
+        if (!Reflection::HasFlag(prop.flags, Reflection::PropFlags::Storable) ||
+            Reflection::HasFlag(prop.flags, Reflection::PropFlags::ReadOnly) ||
+            (accessor.offset == Reflection::PropertyAccessor::NoOffset && !accessor.IsDerivedRaw()) ||
+            prop.id == Instance::prop_Parent) {
+            //The tree itself is stored in the instance table.
+            return false;
+        }
+        if (accessor.IsRaw() || accessor.IsDerivedRaw()) {
+            encoding = Encoding::Raw;
+            return true;
+        }
+        if (accessor.type && *accessor.type == typeid(std::string)) {
+            encoding = Encoding::String;
+            return true;
+        }
+        if (prop.typeFlags == Reflection::PropTypeFlags::RawPointer || prop.typeFlags == Reflection::PropTypeFlags::InstanceRef) {
+            encoding = Encoding::InstanceRef;
+            return true;
+        }
+        return false;
+    }
+
+    uint32_t getElementSize(const Reflection::Property& prop, Encoding encoding) {
+        return encoding == Encoding::Raw ? prop.accessor.size : static_cast<uint32_t>(sizeof(uint32_t));
+    }
+
+    class StringTable {
+    public:
+        uint32_t Intern(std::string_view value) {
+            auto [it, inserted] = indices.try_emplace(value, static_cast<uint32_t>(strings.size()));
+            if (inserted) {
+                strings.push_back(value);
+            }
+            return it->second;
+        }
+        const std::vector<std::string_view>& GetStrings() const { return strings; }
+
+    private:
+        //Views into the saved instances and reflection data, which outlive the write.
+        std::unordered_map<std::string_view, uint32_t> indices;
+        std::vector<std::string_view> strings;
+    };
+}
+
+std::vector<std::byte> PlaceWriter::Write(const std::vector<Instance*>& roots) {
+    //Every saved instance in pre-order, so parents always precede their children.
+    std::vector<Instance*> instances;
+    for (Instance* root : roots) {
+        bool nested = root && std::any_of(roots.begin(), roots.end(), [&](Instance* other) {
+            return other && other != root && root->IsDescendantOf(other);
+        });
+        if (!root || !root->Archivable || nested) {
+            continue;
+        }
+        instances.push_back(root);
+        root->ForEachDescendant([&](Instance* descendant) {
+            if (!descendant->Archivable) {
+                return TraversalAction::SkipChildren;
+            }
+            instances.push_back(descendant);
+            return TraversalAction::Continue;
+        });
+    }
+    std::unordered_map<const Instance*, uint32_t> indexOf;
+    indexOf.reserve(instances.size());
+    for (uint32_t i = 0; i < instances.size(); i++) {
+        //Duplicate roots keep their first position.
+        indexOf.try_emplace(instances[i], i);
+    }
+
+    struct StoredProperty {
+        const Reflection::Property* prop;
+        Encoding encoding;
+        uint64_t dataOffset;
+    };
+    struct ClassBlock {
+        Reflection::Class* cls;
+        std::vector<Instance*> rows;
+        std::vector<StoredProperty> properties;
+        uint64_t propertiesOffset;
+    };
+    std::vector<ClassBlock> classes;
+    std::unordered_map<const Reflection::Class*, uint32_t> classIndexOf;
+    std::vector<InstanceEntry> instanceEntries(instances.size());
+    for (uint32_t i = 0; i < instances.size(); i++) {
+        Instance* instance = instances[i];
+        Reflection::Class* cls = instance->GetClass();
+        auto [it, inserted] = classIndexOf.try_emplace(cls, static_cast<uint32_t>(classes.size()));
+        if (inserted) {
+            classes.push_back({ cls, {}, {}, 0 });
+        }
+        ClassBlock& block = classes[it->second];
+
+        InstanceEntry& entry = instanceEntries[i];
+        std::memcpy(entry.id, instance->Id.bytes, sizeof(entry.id));
+        entry.classIndex = it->second;
+        entry.row = static_cast<uint32_t>(block.rows.size());
+        auto parent = instance->Parent ? indexOf.find(instance->Parent) : indexOf.end();
+        entry.parent = parent != indexOf.end() ? parent->second : NoIndex;
+        entry.reserved = 0;
+        block.rows.push_back(instance);
+    }
+
+    //Lay out everything but the string table, which goes last since it grows while the columns are written.
+    uint64_t offset = sizeof(Header);
+    uint64_t classTableOffset = AlignUp(offset);
+    offset = classTableOffset + classes.size() * sizeof(ClassEntry);
+    for (ClassBlock& block : classes) {
+        for (const Reflection::Property* prop : block.cls->propertyTable.properties) {
+            Encoding encoding;
+            if (getEncoding(*prop, encoding)) {
+                block.properties.push_back({ prop, encoding, 0 });
+            }
+        }
+        block.propertiesOffset = AlignUp(offset);
+        offset = block.propertiesOffset + block.properties.size() * sizeof(PropertyEntry);
+        for (StoredProperty& stored : block.properties) {
+            stored.dataOffset = AlignUp(offset);
+            offset = stored.dataOffset + uint64_t(getElementSize(*stored.prop, stored.encoding)) * block.rows.size();
+        }
+    }
+    uint64_t instanceTableOffset = AlignUp(offset);
+    offset = instanceTableOffset + instances.size() * sizeof(InstanceEntry);
+    uint64_t uuidIndexOffset = AlignUp(offset);
+    offset = uuidIndexOffset + instances.size() * sizeof(uint32_t);
+    uint64_t stringTableOffset = AlignUp(offset);
+
+    std::vector<std::byte> buffer(stringTableOffset);
+    std::byte* out = buffer.data();
+    StringTable strings;
+
+    for (size_t c = 0; c < classes.size(); c++) {
+        const ClassBlock& block = classes[c];
+        ClassEntry classEntry = {};
+        classEntry.classId = block.cls->id;
+        classEntry.nameString = strings.Intern(block.cls->className);
+        classEntry.instanceCount = static_cast<uint32_t>(block.rows.size());
+        classEntry.propertyCount = static_cast<uint32_t>(block.properties.size());
+        classEntry.propertiesOffset = block.propertiesOffset;
+        std::memcpy(out + classTableOffset + c * sizeof(ClassEntry), &classEntry, sizeof(ClassEntry));
+
+        for (size_t p = 0; p < block.properties.size(); p++) {
+            const StoredProperty& stored = block.properties[p];
+            const Reflection::PropertyAccessor& accessor = stored.prop->accessor;
+            uint32_t elementSize = getElementSize(*stored.prop, stored.encoding);
+
+            PropertyEntry propEntry = {};
+            propEntry.propId = stored.prop->id;
+            propEntry.nameString = strings.Intern(stored.prop->name);
+            propEntry.typeString = strings.Intern(stored.prop->type);
+            propEntry.encoding = stored.encoding;
+            propEntry.elementSize = elementSize;
+            propEntry.dataOffset = stored.dataOffset;
+            std::memcpy(out + block.propertiesOffset + p * sizeof(PropertyEntry), &propEntry, sizeof(PropertyEntry));
+
+            std::byte* column = out + stored.dataOffset;
+            for (size_t row = 0; row < block.rows.size(); row++) {
+                const Instance* instance = block.rows[row];
+                std::byte* element = column + row * elementSize;
+                if (accessor.IsDerivedRaw()) {
+                    accessor.readValue(accessor, instance, element);
+                    continue;
+                }
+                const void* field = accessor.FieldPointer(instance);
+                uint32_t index = NoIndex;
+                switch (stored.encoding) {
+                case Encoding::Raw:
+                    std::memcpy(element, field, elementSize);
+                    continue;
+                case Encoding::String:
+                    index = strings.Intern(*static_cast<const std::string*>(field));
+                    break;
+                case Encoding::InstanceRef: {
+                    auto it = indexOf.find(Reflection::ReadInstanceReference(stored.prop->typeFlags, field));
+                    if (it != indexOf.end()) {
+                        index = it->second;
+                    }
+                    break;
+                }
+                }
+                std::memcpy(element, &index, sizeof(index));
+            }
+        }
+    }
+
+    if (!instanceEntries.empty()) {
+        std::memcpy(out + instanceTableOffset, instanceEntries.data(), instanceEntries.size() * sizeof(InstanceEntry));
+    }
+
+    std::vector<uint32_t> uuidIndex(instances.size());
+    for (uint32_t i = 0; i < uuidIndex.size(); i++) {
+        uuidIndex[i] = i;
+    }
+    std::sort(uuidIndex.begin(), uuidIndex.end(), [&](uint32_t a, uint32_t b) {
+        return std::memcmp(instanceEntries[a].id, instanceEntries[b].id, sizeof(InstanceEntry::id)) < 0;
+    });
+    if (!uuidIndex.empty()) {
+        std::memcpy(out + uuidIndexOffset, uuidIndex.data(), uuidIndex.size() * sizeof(uint32_t));
+    }
+
+    //Now that every string is known, append the string table and its bytes.
+    const std::vector<std::string_view>& stringList = strings.GetStrings();
+    uint64_t stringDataOffset = stringTableOffset + stringList.size() * sizeof(StringEntry);
+    uint64_t stringDataSize = 0;
+    for (std::string_view value : stringList) {
+        stringDataSize += value.size();
+    }
+    buffer.resize(stringDataOffset + stringDataSize);
+    out = buffer.data();
+    uint64_t stringOffset = stringDataOffset;
+    for (size_t s = 0; s < stringList.size(); s++) {
+        StringEntry stringEntry = {};
+        stringEntry.offset = stringOffset;
+        stringEntry.length = static_cast<uint32_t>(stringList[s].size());
+        std::memcpy(out + stringTableOffset + s * sizeof(StringEntry), &stringEntry, sizeof(StringEntry));
+        std::memcpy(out + stringOffset, stringList[s].data(), stringList[s].size());
+        stringOffset += stringList[s].size();
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.classCount = static_cast<uint32_t>(classes.size());
+    header.instanceCount = static_cast<uint32_t>(instances.size());
+    header.stringCount = static_cast<uint32_t>(stringList.size());
+    header.classTableOffset = classTableOffset;
+    header.instanceTableOffset = instanceTableOffset;
+    header.uuidIndexOffset = uuidIndexOffset;
+    header.stringTableOffset = stringTableOffset;
+    header.fileSize = buffer.size();
+    std::memcpy(out, &header, sizeof(Header));
+    return buffer;
+}
+
+void PlaceWriter::Save(const std::vector<Instance*>& roots, const std::string& path) {
+    std::vector<std::byte> buffer = Write(roots);
+    std::ofstream stream(path, std::ios::binary | std::ios::trunc);
+    if (!stream) {
+        throw std::runtime_error("Cannot open place file for writing: " + path);
+    }
+    stream.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    if (!stream) {
+        throw std::runtime_error("Cannot write place file: " + path);
+    }
+}
+
+PlaceReader::PlaceReader(const std::string& path)
+    : file(path) {
+    data = file.GetData();
+    size = file.GetSize();
+    validate();
+}
+
+PlaceReader::PlaceReader(const std::byte* _data, size_t _size)
+    : data(_data), size(_size) {
+    validate();
+}
+
+void PlaceReader::validate() {
+    header = at<Header>(0, 1);
+    if (std::memcmp(header->magic, Magic, sizeof(Magic)) != 0) {
+        throw std::runtime_error("Not a place file");
+    }
+    if (header->version != Version) {
+        throw std::runtime_error("Unsupported place file version " + std::to_string(header->version));
+    }
+    if (header->fileSize != size) {
+        throw std::runtime_error("Place file is truncated");
+    }
+    at<ClassEntry>(header->classTableOffset, header->classCount);
+    at<InstanceEntry>(header->instanceTableOffset, header->instanceCount);
+    at<uint32_t>(header->uuidIndexOffset, header->instanceCount);
+    at<StringEntry>(header->stringTableOffset, header->stringCount);
+}
+
+template<typename T>
+const T* PlaceReader::at(uint64_t offset, uint64_t count) const {
+    if (offset > size || count > (size - offset) / sizeof(T) || offset % alignof(T) != 0) {
+        throw std::runtime_error("Place file is corrupt");
+    }
+    return reinterpret_cast<const T*>(data + offset);
+}
+
+std::string_view PlaceReader::getString(uint32_t index) const {
+    if (index >= header->stringCount) {
+        throw std::runtime_error("Place file is corrupt");
+    }
+    const StringEntry& entry = at<StringEntry>(header->stringTableOffset, header->stringCount)[index];
+    return std::string_view(reinterpret_cast<const char*>(at<char>(entry.offset, entry.length)), entry.length);
+}
+
+uint32_t PlaceReader::FindInstance(const EngineUUID& id) const {
+    const InstanceEntry* instances = at<InstanceEntry>(header->instanceTableOffset, header->instanceCount);
+    const uint32_t* begin = at<uint32_t>(header->uuidIndexOffset, header->instanceCount);
+    const uint32_t* end = begin + header->instanceCount;
+    const uint32_t* it = std::lower_bound(begin, end, id, [&](uint32_t index, const EngineUUID& value) {
+        return index < header->instanceCount && std::memcmp(instances[index].id, value.bytes, sizeof(value.bytes)) < 0;
+    });
+    if (it != end && *it < header->instanceCount && std::memcmp(instances[*it].id, id.bytes, sizeof(id.bytes)) == 0) {
+        return *it;
+    }
+    return NoIndex;
+}
+
+std::vector<Instance*> PlaceReader::Load(Engine* engine) {
+    std::vector<InstanceRef<>> loaded(header->instanceCount);
+    return materialize(engine, 0, header->instanceCount, nullptr, NoIndex, NoIndex, loaded);
+}
+
+std::vector<Instance*> PlaceReader::LoadStreamed(Engine* engine, uint32_t stubDepth) {
+    if (stream) {
+        throw std::runtime_error("This place is already being streamed");
+    }
+    //Throws std::bad_weak_ptr up front if the reader is not shared, rather than when a stub first loads.
+    (void)shared_from_this();
+    std::unique_ptr<StreamState> state = std::make_unique<StreamState>();
+    state->engine = engine;
+    state->loaded.assign(header->instanceCount, InstanceRef<>());
+    state->subtreeEnd = computeSubtreeEnds();
+    stream = std::move(state);
+    try {
+        return materialize(engine, 0, header->instanceCount, nullptr, NoIndex, stubDepth, stream->loaded);
+    } catch (...) {
+        stream.reset();
+        throw;
+    }
+}
+
+void PlaceReader::LoadSubtree(Instance* stub) {
+    std::unique_ptr<UnloadedSubtree> subtree = std::move(stub->unloadedSubtree);
+    if (!subtree) {
+        return;
+    }
+    if (subtree->prefetch.valid()) {
+        subtree->prefetch.wait();
+    }
+    uint32_t index = subtree->index;
+    if (!stream || subtree->reader.get() != this || index >= header->instanceCount) {
+        throw std::runtime_error("Instance " + stub->Name + " was not streamed from this place");
+    }
+
+    materialize(stream->engine, index + 1, stream->subtreeEnd[index], stub, index, NoIndex, stream->loaded);
+
+    //To the rest of the tree these instances are only arriving now.
+    std::vector<Instance*> children = stub->Children;
+    if (!children.empty()) {
+        stub->raisePropChanged(Instance::prop_Children);
+        for (Instance* child : children) {
+            stub->ChildAdded.Fire(child);
+        }
+        Instance::notifyDescendants(stub, children, true);
+    }
+}
+
+void PlaceReader::PrefetchSubtree(uint32_t index) const {
+    if (!stream || index >= header->instanceCount) {
+        return;
+    }
+    //Reading one byte per page is enough to fault the page in.
+    constexpr uint64_t PageSize = 4096;
+    volatile uint8_t sink = 0;
+    auto touch = [&](uint64_t offset, uint64_t length) {
+        for (uint64_t at = offset; at < offset + length && at < size; at += PageSize) {
+            sink = sink + static_cast<uint8_t>(data[at]);
+        }
+        if (length > 0 && offset + length <= size) {
+            sink = sink + static_cast<uint8_t>(data[offset + length - 1]);
+        }
+    };
+
+    uint32_t begin = index + 1;
+    uint32_t end = stream->subtreeEnd[index];
+    if (begin >= end) {
+        return;
+    }
+    touch(header->instanceTableOffset + uint64_t(begin) * sizeof(InstanceEntry), uint64_t(end - begin) * sizeof(InstanceEntry));
+
+    //Rows are handed out in pre-order, so the subtree occupies one contiguous run of rows in each class's columns.
+    const ClassEntry* classEntries = at<ClassEntry>(header->classTableOffset, header->classCount);
+    const InstanceEntry* instanceEntries = at<InstanceEntry>(header->instanceTableOffset, header->instanceCount);
+    std::vector<std::pair<uint32_t, uint32_t>> rowRanges(header->classCount, { NoIndex, 0 });
+    for (uint32_t i = begin; i < end; i++) {
+        const InstanceEntry& entry = instanceEntries[i];
+        if (entry.classIndex < header->classCount) {
+            auto& [firstRow, lastRow] = rowRanges[entry.classIndex];
+            firstRow = std::min(firstRow, entry.row);
+            lastRow = std::max(lastRow, entry.row);
+        }
+    }
+    for (uint32_t c = 0; c < header->classCount; c++) {
+        auto [firstRow, lastRow] = rowRanges[c];
+        if (firstRow == NoIndex) {
+            continue;
+        }
+        const ClassEntry& classEntry = classEntries[c];
+        const PropertyEntry* propEntries = at<PropertyEntry>(classEntry.propertiesOffset, classEntry.propertyCount);
+        for (uint32_t p = 0; p < classEntry.propertyCount; p++) {
+            const PropertyEntry& propEntry = propEntries[p];
+            touch(propEntry.dataOffset + uint64_t(firstRow) * propEntry.elementSize, uint64_t(lastRow - firstRow + 1) * propEntry.elementSize);
+        }
+    }
+}
+
+std::vector<uint32_t> PlaceReader::computeSubtreeEnds() const {
+    const uint32_t instanceCount = header->instanceCount;
+    const InstanceEntry* instanceEntries = at<InstanceEntry>(header->instanceTableOffset, instanceCount);
+    std::vector<uint32_t> subtreeEnd(instanceCount, instanceCount);
+    //The open ancestors of the current instance; in pre-order a subtree ends where one of them is left behind.
+    std::vector<uint32_t> open;
+    for (uint32_t i = 0; i < instanceCount; i++) {
+        uint32_t parent = instanceEntries[i].parent;
+        while (!open.empty() && open.back() != parent) {
+            subtreeEnd[open.back()] = i;
+            open.pop_back();
+        }
+        if (parent != NoIndex && open.empty()) {
+            throw std::runtime_error("Place file is corrupt");
+        }
+        open.push_back(i);
+    }
+    return subtreeEnd;
+}
+
+std::vector<Instance*> PlaceReader::materialize(Engine* engine, uint32_t begin, uint32_t end, Instance* rangeParent,
+    uint32_t rangeParentIndex, uint32_t stubDepth, std::vector<InstanceRef<>>& loaded) {
+    Reflection::Registry& registry = Reflection::GetRegistry();
+    const uint32_t classCount = header->classCount;
+    const uint32_t instanceCount = header->instanceCount;
+    const ClassEntry* classEntries = at<ClassEntry>(header->classTableOffset, classCount);
+    const InstanceEntry* instanceEntries = at<InstanceEntry>(header->instanceTableOffset, instanceCount);
+
+    std::vector<Reflection::Class*> classes(classCount);
+    for (uint32_t c = 0; c < classCount; c++) {
+        Reflection::Class* cls = registry.GetClassById(classEntries[c].classId);
+        classes[c] = (cls && !cls->isInterface) ? cls : nullptr;
+    }
+
+    //What this call creates, in instance table order, and for each class its (row, instance) pairs in row order.
+    std::vector<uint32_t> created;
+    std::vector<std::vector<std::pair<uint32_t, Instance*>>> rows(classCount);
+    std::vector<uint32_t> depth(end - begin, 0);
+    try {
+        //Create everything up front, so instance references can be resolved in a single pass.
+        for (uint32_t i = begin; i < end; i++) {
+            const InstanceEntry& entry = instanceEntries[i];
+            uint32_t parent = entry.parent;
+            bool rangeRoot = parent == NoIndex || parent == rangeParentIndex;
+            if (entry.classIndex >= classCount || entry.row >= classEntries[entry.classIndex].instanceCount ||
+                (!rangeRoot && (parent < begin || parent >= i))) {
+                throw std::runtime_error("Place file is corrupt");
+            }
+            Reflection::Class* cls = classes[entry.classIndex];
+            if (!cls || (!rangeRoot && !loaded[parent])) {
+                continue;
+            }
+            Instance* instance = cls->Instantiate(engine);
+            if (!instance) {
+                continue;
+            }
+            //Keep the fresh Id if the saved one is taken, such as by an earlier load of the same place, rather
+            //than steal it from the instance already filed under it.
+            EngineUUID id(entry.id);
+            if (!engine || !engine->FindInstance(id)) {
+                instance->AssignId(id);
+            }
+            loaded[i] = InstanceRef<>(instance);
+            created.push_back(i);
+            rows[entry.classIndex].emplace_back(entry.row, instance);
+
+            depth[i - begin] = rangeRoot ? 0 : depth[parent - begin] + 1;
+            if (depth[i - begin] == stubDepth && stream && stream->subtreeEnd[i] > i + 1) {
+                std::unique_ptr<UnloadedSubtree> subtree = std::make_unique<UnloadedSubtree>();
+                subtree->reader = shared_from_this();
+                subtree->index = i;
+                instance->unloadedSubtree = std::move(subtree);
+                i = stream->subtreeEnd[i] - 1;
+            }
+        }
+
+        //Apply each column to its class's instances, straight into the fields. Derived properties go through their setter.
+        for (uint32_t c = 0; c < classCount; c++) {
+            Reflection::Class* cls = classes[c];
+            if (!cls || rows[c].empty()) {
+                continue;
+            }
+            const ClassEntry& classEntry = classEntries[c];
+            const PropertyEntry* propEntries = at<PropertyEntry>(classEntry.propertiesOffset, classEntry.propertyCount);
+
+            for (uint32_t p = 0; p < classEntry.propertyCount; p++) {
+                const PropertyEntry& propEntry = propEntries[p];
+                const Reflection::Property* prop = cls->FindProperty(propEntry.propId);
+                Encoding encoding;
+                if (!prop || !getEncoding(*prop, encoding) || encoding != propEntry.encoding ||
+                    getElementSize(*prop, encoding) != propEntry.elementSize ||
+                    (encoding == Encoding::Raw && getString(propEntry.typeString) != prop->type)) {
+                    //Removed, no longer stored, or changed type since the place was saved.
+                    continue;
+                }
+                const Reflection::PropertyAccessor& accessor = prop->accessor;
+                const uint32_t elementSize = propEntry.elementSize;
+                const std::byte* column = at<std::byte>(propEntry.dataOffset, uint64_t(elementSize) * classEntry.instanceCount);
+
+                for (auto [row, instance] : rows[c]) {
+                    const std::byte* element = column + uint64_t(row) * elementSize;
+                    if (accessor.IsDerivedRaw()) {
+                        accessor.writeValue(accessor, instance, element);
+                        continue;
+                    }
+                    void* field = accessor.FieldPointer(instance);
+                    if (encoding == Encoding::Raw) {
+                        std::memcpy(field, element, elementSize);
+                        continue;
+                    }
+                    uint32_t index;
+                    std::memcpy(&index, element, sizeof(index));
+                    if (encoding == Encoding::String) {
+                        *static_cast<std::string*>(field) = getString(index);
+                        continue;
+                    }
+                    Instance* target = index < instanceCount ? loaded[index].Get() : nullptr;
+                    Reflection::WriteInstanceReference(prop->typeFlags, field, target);
+                    //Not loaded yet, as opposed to loaded and destroyed since.
+                    if (!target && index < instanceCount && loaded[index] == InstanceRef<>() && stream) {
+                        stream->pendingReferences.emplace(index, std::make_pair(InstanceRef<>(instance), prop));
+                    }
+                }
+            }
+        }
+    } catch (...) {
+        for (uint32_t i : created) {
+            Instance* instance = loaded[i].Get();
+            instance->GetClass()->Destroy(instance);
+            loaded[i] = InstanceRef<>();
+        }
+        throw;
+    }
+
+    //Point references made by earlier loads at whatever just arrived.
+    if (stream && !stream->pendingReferences.empty()) {
+        for (uint32_t i : created) {
+            auto [first, last] = stream->pendingReferences.equal_range(i);
+            for (auto it = first; it != last; it++) {
+                auto [owner, prop] = it->second;
+                //The owner may have been destroyed since.
+                if (Instance* instance = owner.Get()) {
+                    Reflection::WriteInstanceReference(prop->typeFlags, prop->accessor.FieldPointer(instance), loaded[i].Get());
+                }
+            }
+            stream->pendingReferences.erase(first, last);
+        }
+    }
+
+    //Link the trees back up in file order, which keeps every parent's children in their saved order.
+    std::vector<Instance*> roots;
+    for (uint32_t i : created) {
+        Instance* instance = loaded[i].Get();
+        uint32_t parentIndex = instanceEntries[i].parent;
+        if (parentIndex == NoIndex) {
+            roots.push_back(instance);
+            continue;
+        }
+        instance->Parent = parentIndex == rangeParentIndex ? rangeParent : loaded[parentIndex].Get();
+        instance->Parent->attachChildren({ &instance, 1 });
+    }
+    for (uint32_t i : created) {
+        Instance* instance = loaded[i].Get();
+        if (instance->Parent) {
+            instance->__onParentChanged(instance->Parent);
+        }
+    }
+    return roots;
+}
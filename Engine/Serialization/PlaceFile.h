@@ -0,0 +1,115 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Core/Export.h"
+#include "Instance/InstanceRef.h"
+#include "Instance/UUID.h"
+#include "Serialization/MappedFile.h"
+#include "Serialization/PlaceFormat.h"
+
+class Instance;
+class Engine;
+
+namespace Reflection {
+    struct Property;
+}
+
+/// Writes instance trees in the binary place format described in PlaceFormat.h.
+/// Instances whose Archivable is false are left out along with their descendants, and only
+/// properties flagged Storable (and not ReadOnly) are written.
+class GP_EXPORT PlaceWriter {
+public:
+    /// Serializes roots and their descendants. A root that is a descendant of another root is saved as
+    /// part of that root's tree. Instance references to anything that is not saved are written as null.
+    static std::vector<std::byte> Write(const std::vector<Instance*>& roots);
+
+    /// Writes the place to a file, replacing it. Throws std::runtime_error if the file cannot be written.
+    static void Save(const std::vector<Instance*>& roots, const std::string& path);
+};
+
+class PlaceReader;
+
+/// Descendants of a streamed instance that are still in the place file. Owned by that instance until
+/// Instance::LoadSubtree() materializes them.
+struct UnloadedSubtree {
+    /// Keeps the reader, and with it the mapping, alive for as long as anything is left to load.
+    std::shared_ptr<PlaceReader> reader;
+    /// The stub instance's own index in the instance table. Its descendants follow it in pre-order.
+    uint32_t index = 0;
+    /// Set by Instance::PrefetchSubtree() while the subtree is being paged in.
+    std::shared_future<void> prefetch;
+};
+
+/// Reads a binary place file in place, from a memory mapping or a buffer.
+class GP_EXPORT PlaceReader : public std::enable_shared_from_this<PlaceReader> {
+public:
+    /// Maps the file at path. Throws std::runtime_error if it cannot be mapped or is not a place file.
+    explicit PlaceReader(const std::string& path);
+    /// Reads a place held in memory, which must outlive the reader.
+    PlaceReader(const std::byte* data, size_t size);
+
+    /// Creates every saved instance, links them back into their trees and returns the roots, unparented.
+    /// Instances of classes this build does not know are skipped, along with their descendants.
+    /// Properties are written straight into the new instances, so no change notifications are raised.
+    /// Instances keep their saved Id unless an instance with that Id is already live in the engine, in which
+    /// case they keep the fresh one they were created with. Loading a place twice gives two independent
+    /// copies, and only the first copy has the saved Ids.
+    /// Throws std::runtime_error if the file is malformed, in which case nothing is left behind.
+    std::vector<Instance*> Load(Engine* engine);
+
+    /// As Load, but instances stubDepth levels below the roots (the roots' children by default, usually
+    /// the place's top-level containers) are created without their descendants. Each such stub keeps an
+    /// UnloadedSubtree and materializes it on first touch, see Instance::LoadSubtree().
+    /// Instance references to instances that are not loaded yet are null until their target streams in.
+    /// The reader must be owned by a std::shared_ptr, since stubs keep it alive. A reader streams one place.
+    std::vector<Instance*> LoadStreamed(Engine* engine, uint32_t stubDepth = 1);
+
+    /// Materializes a stub's descendants and fires the usual ChildAdded/DescendantAdded events for them.
+    /// Called by Instance::LoadSubtree().
+    void LoadSubtree(Instance* stub);
+    /// Touches every page holding a stub's descendants, so LoadSubtree does not stall on I/O.
+    /// Only reads the mapping, so it is safe to run on another thread.
+    void PrefetchSubtree(uint32_t index) const;
+
+    uint32_t GetInstanceCount() const { return header->instanceCount; }
+    /// Index in the instance table of the instance saved with the given id, or PlaceFormat::NoIndex.
+    uint32_t FindInstance(const EngineUUID& id) const;
+
+private:
+    MappedFile file;
+    const std::byte* data = nullptr;
+    size_t size = 0;
+    const PlaceFormat::Header* header = nullptr;
+
+    struct StreamState {
+        Engine* engine = nullptr;
+        /// Instances materialized so far, by instance table index. Weak, since any of them may be destroyed
+        /// while the rest of the place streams in.
+        std::vector<InstanceRef<>> loaded;
+        /// One past the last descendant of each instance.
+        std::vector<uint32_t> subtreeEnd;
+        /// Reference fields waiting for their target to stream in, keyed on the target's index.
+        std::unordered_multimap<uint32_t, std::pair<InstanceRef<>, const Reflection::Property*>> pendingReferences;
+    };
+    std::unique_ptr<StreamState> stream;
+
+    void validate();
+    std::vector<uint32_t> computeSubtreeEnds() const;
+
+    /// Creates instances [begin, end) of the instance table into loaded. Those whose parent is rangeParentIndex
+    /// are attached to rangeParent; the rest of the range's roots are returned. Instances stubDepth levels
+    /// down the range that have descendants are made stubs, and their descendants skipped.
+    std::vector<Instance*> materialize(Engine* engine, uint32_t begin, uint32_t end, Instance* rangeParent,
+        uint32_t rangeParentIndex, uint32_t stubDepth, std::vector<InstanceRef<>>& loaded);
+
+    /// Bounds-checked view of count Ts at offset. Throws if any of it falls outside the file.
+    template<typename T>
+    const T* at(uint64_t offset, uint64_t count) const;
+    std::string_view getString(uint32_t index) const;
+};
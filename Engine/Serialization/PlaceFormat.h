@@ -0,0 +1,94 @@
+#pragma once
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+/// On-disk layout of a binary place file. Everything is little-endian, fixed-size and 8-byte aligned,
+/// so a mapped file is read in place and never parsed into an intermediate representation.
+///
+///     Header
+///     ClassEntry[classCount]
+///         PropertyEntry[propertyCount] for each class, at ClassEntry::propertiesOffset
+///         one column per property, ClassEntry::instanceCount elements of PropertyEntry::elementSize bytes
+///     InstanceEntry[instanceCount]        the saved trees in pre-order, so parents precede their children
+///     uint32_t uuidIndex[instanceCount]   instance indices sorted by id, for lookups by EngineUUID
+///     StringEntry[stringCount], followed by the string bytes
+///
+/// Columns are matched to properties by id when loading. Columns whose property no longer exists, or
+/// whose type has changed, are skipped, so a place survives most changes to the reflected classes.
+namespace PlaceFormat {
+    static_assert(std::endian::native == std::endian::little, "Place files are read in place and assume a little-endian host");
+
+    inline constexpr char Magic[4] = { 'G', 'P', 'P', 'L' };
+    inline constexpr uint32_t Version = 1;
+    inline constexpr uint32_t NoIndex = ~0u;
+    inline constexpr size_t Alignment = 8;
+
+    enum class Encoding : uint32_t {
+        /// The field's bytes, copied as is. Only for trivially copyable, non-pointer fields.
+        Raw = 0,
+        /// uint32_t index into the string table.
+        String = 1,
+        /// uint32_t index into the instance table, or NoIndex for null and for instances that were not saved.
+        InstanceRef = 2
+    };
+
+    struct Header {
+        char magic[4];
+        uint32_t version;
+        uint32_t classCount;
+        uint32_t instanceCount;
+        uint32_t stringCount;
+        uint32_t reserved;
+        uint64_t classTableOffset;
+        uint64_t instanceTableOffset;
+        uint64_t uuidIndexOffset;
+        uint64_t stringTableOffset;
+        uint64_t fileSize;
+    };
+
+    struct ClassEntry {
+        uint64_t classId;
+        uint32_t nameString;
+        uint32_t instanceCount;
+        uint32_t propertyCount;
+        uint32_t reserved;
+        uint64_t propertiesOffset;
+    };
+
+    struct PropertyEntry {
+        uint64_t propId;
+        uint32_t nameString;
+        /// The property's C++ type as reflected, checked against the loading build for Raw columns.
+        uint32_t typeString;
+        Encoding encoding;
+        uint32_t elementSize;
+        uint64_t dataOffset;
+    };
+
+    struct InstanceEntry {
+        uint8_t id[16];
+        uint32_t classIndex;
+        /// Row of this instance in its class's columns.
+        uint32_t row;
+        /// Index of the parent in the instance table, or NoIndex for the root of a saved tree.
+        uint32_t parent;
+        uint32_t reserved;
+    };
+
+    struct StringEntry {
+        uint64_t offset;
+        uint32_t length;
+        uint32_t reserved;
+    };
+
+    static_assert(sizeof(Header) == 64);
+    static_assert(sizeof(ClassEntry) == 32);
+    static_assert(sizeof(PropertyEntry) == 32);
+    static_assert(sizeof(InstanceEntry) == 32);
+    static_assert(sizeof(StringEntry) == 16);
+
+    inline constexpr uint64_t AlignUp(uint64_t offset) {
+        return (offset + Alignment - 1) & ~static_cast<uint64_t>(Alignment - 1);
+    }
+}
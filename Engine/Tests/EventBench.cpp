@@ -0,0 +1,71 @@
+//Timings for MulticastEvent: Fire with 0, 1, 8 and 1000 listeners, and Connect/Disconnect on one thread and
+//on several at once, which is where the process-wide connection table would contend. Prints nanoseconds per
+//operation; not run by CTest.
+#include "Core/Event.h"
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	double nanosecondsPer(Clock::time_point start, size_t operations) {
+		return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / double(operations);
+	}
+
+	void benchFire(uint32_t listeners) {
+		MulticastEvent<int> event;
+		uint64_t sum = 0;
+		for (uint32_t i = 0; i < listeners; i++) {
+			event.Connect([&sum](int value) { sum += value; });
+		}
+		//Roughly the same number of listener calls for every size, and at least some fires for none.
+		const size_t fires = listeners > 0 ? 10'000'000 / listeners : 10'000'000;
+		Clock::time_point start = Clock::now();
+		for (size_t i = 0; i < fires; i++) {
+			event.Fire(static_cast<int>(i));
+		}
+		double perFire = nanosecondsPer(start, fires);
+		std::printf("Fire, %4u listeners: %10.2f ns/fire %8.3f ns/listener (%llu)\n", listeners, perFire,
+			listeners > 0 ? perFire / listeners : 0.0, static_cast<unsigned long long>(sum));
+	}
+
+	void connectDisconnect(size_t rounds) {
+		MulticastEvent<> event;
+		std::vector<MulticastEvent<>::Connection> connections(8);
+		for (size_t round = 0; round < rounds; round++) {
+			for (MulticastEvent<>::Connection& connection : connections) {
+				connection = event.Connect([]() {});
+			}
+			for (MulticastEvent<>::Connection& connection : connections) {
+				connection.Disconnect();
+			}
+		}
+	}
+
+	void benchConnect(size_t threads) {
+		const size_t rounds = 200'000;
+		Clock::time_point start = Clock::now();
+		std::vector<std::thread> workers;
+		for (size_t i = 0; i < threads; i++) {
+			workers.emplace_back(connectDisconnect, rounds);
+		}
+		for (std::thread& worker : workers) {
+			worker.join();
+		}
+		//Wall time per Connect+Disconnect pair on each thread.
+		std::printf("Connect+Disconnect, %zu threads: %8.2f ns/pair\n", threads, nanosecondsPer(start, rounds * 8));
+	}
+}
+
+int main() {
+	for (uint32_t listeners : { 0u, 1u, 8u, 1000u }) {
+		benchFire(listeners);
+	}
+	unsigned int cores = std::thread::hardware_concurrency();
+	for (size_t threads : { size_t(1), size_t(cores > 1 ? cores : 2) }) {
+		benchConnect(threads);
+	}
+	return 0;
+}
@@ -0,0 +1,98 @@
+//Timings for the binary place format: writing, an eager load, and a streamed load with its first LoadSubtree,
+//both from a buffer and from a mapped file. Takes the number of models as its argument. Not run by CTest.
+#include "Instance/Instance.h"
+#include "Instance/World.h"
+#include "Instance/ObjectInstance.h"
+#include "Physics/Attachment.h"
+#include "Physics/Constraints/HingeConstraint.h"
+#include "Serialization/PlaceFile.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+//This must be the LAST thing included.
+#include "ReflectionRegistry.h"
+
+namespace {
+	using Clock = std::chrono::steady_clock;
+
+	double millisecondsSince(Clock::time_point start) {
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	/// A World and a plain container, each with models of a few parts, every part with an attachment and a hinge.
+	Instance* buildPlace(int models) {
+		Instance* game = Instance::StaticClass().Instantiate(nullptr);
+		game->SetName("Game");
+		Instance* workspace = World::StaticClass().Instantiate(nullptr);
+		workspace->SetName("Workspace");
+		workspace->SetParent(game);
+		Instance* storage = Instance::StaticClass().Instantiate(nullptr);
+		storage->SetName("Storage");
+		storage->SetParent(game);
+
+		Attachment* previous = nullptr;
+		for (int m = 0; m < models; m++) {
+			Instance* model = ObjectInstance::StaticClass().Instantiate(nullptr);
+			model->SetName("Model" + std::to_string(m));
+			model->SetParent(m % 2 ? storage : workspace);
+			for (int p = 0; p < 4; p++) {
+				Instance* part = ObjectInstance::StaticClass().Instantiate(nullptr);
+				part->SetName("Part" + std::to_string(p));
+				part->SetParent(model);
+				Attachment* attachment = Attachment::StaticClass().InstantiateAs<Attachment>(nullptr);
+				attachment->SetParent(part);
+				HingeConstraint* hinge = HingeConstraint::StaticClass().InstantiateAs<HingeConstraint>(nullptr);
+				hinge->SetParent(part);
+				hinge->Attachment0 = attachment;
+				hinge->Attachment1 = previous;
+				previous = attachment;
+			}
+		}
+		return game;
+	}
+}
+
+int main(int argc, char** argv) {
+	Reflection::registerAllClasses();
+	int models = argc > 1 ? std::atoi(argv[1]) : 10000;
+	Instance* game = buildPlace(models);
+	size_t instanceCount = game->GetDescendants().size() + 1;
+
+	Clock::time_point start = Clock::now();
+	std::vector<std::byte> bytes = PlaceWriter::Write({ game });
+	std::printf("%zu instances, %zu bytes\n", instanceCount, bytes.size());
+	std::printf("Write:                     %8.2f ms\n", millisecondsSince(start));
+
+	start = Clock::now();
+	Instance* eager = PlaceReader(bytes.data(), bytes.size()).Load(nullptr)[0];
+	std::printf("Load:                      %8.2f ms\n", millisecondsSince(start));
+	eager->Destroy();
+
+	start = Clock::now();
+	std::shared_ptr<PlaceReader> reader = std::make_shared<PlaceReader>(bytes.data(), bytes.size());
+	Instance* streamed = reader->LoadStreamed(nullptr)[0];
+	std::printf("LoadStreamed:              %8.2f ms\n", millisecondsSince(start));
+	start = Clock::now();
+	streamed->FindFirstChild("Storage")->LoadSubtree();
+	std::printf("LoadSubtree (Storage):     %8.2f ms\n", millisecondsSince(start));
+	streamed->Destroy();
+	reader.reset();
+
+	std::string path = (std::filesystem::temp_directory_path() / "PlaceFileBench.place").string();
+	PlaceWriter::Save({ game }, path);
+	start = Clock::now();
+	std::shared_ptr<PlaceReader> mapped = std::make_shared<PlaceReader>(path);
+	Instance* fromFile = mapped->LoadStreamed(nullptr)[0];
+	std::printf("Map + LoadStreamed:        %8.2f ms\n", millisecondsSince(start));
+	fromFile->Destroy();
+	mapped.reset();
+	std::filesystem::remove(path);
+
+	game->Destroy();
+	return 0;
+}
@@ -0,0 +1,292 @@
+//Round trips through the binary place format: eager and streamed loads, Archivable, instance references, and
+//malformed files. Returns non-zero if any check fails.
+#include "Core/Engine.h"
+#include "Instance/Instance.h"
+#include "Instance/World.h"
+#include "Instance/ObjectInstance.h"
+#include "Physics/Attachment.h"
+#include "Physics/Constraints/HingeConstraint.h"
+#include "Serialization/PlaceFile.h"
+#include "Serialization/PlaceFormat.h"
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+//This must be the LAST thing included.
+#include "ReflectionRegistry.h"
+
+namespace {
+	int failures = 0;
+
+	#define CHECK(condition) \
+		do { \
+			if (!(condition)) { \
+				std::printf("  FAILED %s (line %d)\n", #condition, __LINE__); \
+				failures++; \
+			} \
+		} while (0)
+
+	template<typename T>
+	T* create(const char* name, Instance* parent = nullptr, Engine* engine = nullptr) {
+		T* instance = T::StaticClass().template InstantiateAs<T>(engine);
+		instance->SetName(name);
+		if (parent) {
+			instance->SetParent(parent);
+		}
+		return instance;
+	}
+
+	template<typename F>
+	bool throwsRuntimeError(F&& load) {
+		try {
+			load();
+		} catch (std::runtime_error&) {
+			return true;
+		}
+		return false;
+	}
+
+	/// Game
+	///   Workspace (World)
+	///     Model0..ModelN (ObjectInstance), each with a Part (ObjectInstance) holding an Attachment and a HingeConstraint
+	///     Hidden (not Archivable), with a child
+	///   Storage
+	///     Spare (Attachment)
+	/// Each hinge points at its own attachment and at Storage.Spare, so references cross between the top-level
+	/// containers, and the last one also points at Hidden's child, which is not saved.
+	struct Place {
+		Instance* game;
+		World* workspace;
+		Instance* storage;
+		Instance* hidden;
+		Attachment* hiddenChild;
+		Attachment* spare;
+	};
+
+	Place buildPlace(int models) {
+		Place place;
+		place.game = create<Instance>("Game");
+		place.workspace = create<World>("Workspace", place.game);
+		place.storage = create<Instance>("Storage", place.game);
+		place.spare = create<Attachment>("Spare", place.storage);
+		place.hidden = create<Instance>("Hidden");
+		place.hidden->Archivable = false;
+		place.hiddenChild = create<Attachment>("HiddenChild", place.hidden);
+		for (int m = 0; m < models; m++) {
+			ObjectInstance* model = create<ObjectInstance>(("Model" + std::to_string(m)).c_str(), place.workspace);
+			ObjectInstance* part = create<ObjectInstance>("Part", model);
+			Math::Transform<double> transform;
+			transform.SetTranslation(Math::Vector3<double>(m, 2.0 * m, -1.0));
+			part->SetWorldTransform(transform);
+			Attachment* attachment = create<Attachment>("Attachment", part);
+			HingeConstraint* hinge = create<HingeConstraint>("Hinge", part);
+			hinge->Attachment0 = attachment;
+			hinge->Attachment1 = place.spare;
+			if (m == models - 1) {
+				hinge->Attachment0 = place.hiddenChild;
+			}
+		}
+		place.hidden->SetParent(place.workspace);
+		return place;
+	}
+
+	/// The loaded counterpart of original, found by walking the same names from the other root.
+	Instance* counterpart(Instance* original, Instance* originalRoot, Instance* loadedRoot) {
+		if (original == originalRoot) {
+			return loadedRoot;
+		}
+		Instance* loadedParent = counterpart(original->Parent, originalRoot, loadedRoot);
+		return loadedParent ? loadedParent->FindFirstChild(original->Name) : nullptr;
+	}
+
+	void testRoundTrip() {
+		std::printf("RoundTrip\n");
+		Place place = buildPlace(50);
+		std::vector<std::byte> bytes = PlaceWriter::Write({ place.game });
+		PlaceReader reader(bytes.data(), bytes.size());
+		std::vector<Instance*> roots = reader.Load(nullptr);
+		CHECK(roots.size() == 1);
+		if (roots.size() != 1) {
+			return;
+		}
+		Instance* game = roots[0];
+
+		std::vector<Instance*> original = place.game->GetDescendants();
+		std::erase_if(original, [&](Instance* instance) {
+			return instance == place.hidden || instance->IsDescendantOf(place.hidden);
+		});
+		std::vector<Instance*> loaded = game->GetDescendants();
+		CHECK(loaded.size() == original.size());
+		CHECK(reader.GetInstanceCount() == original.size() + 1);
+		for (size_t i = 0; i < original.size() && i < loaded.size(); i++) {
+			Instance* before = original[i];
+			Instance* after = loaded[i];
+			//Children keep their saved order, so the pre-order walks line up.
+			CHECK(after->GetClass() == before->GetClass());
+			CHECK(after->Name == before->Name);
+			CHECK(after->Id == before->Id);
+			CHECK(reader.FindInstance(before->Id) != PlaceFormat::NoIndex);
+			if (before->IsA<ObjectInstance>()) {
+				ObjectInstance* objectBefore = static_cast<ObjectInstance*>(before);
+				ObjectInstance* objectAfter = static_cast<ObjectInstance*>(after);
+				Math::Vector3<double> translationBefore = objectBefore->GetWorldTransform().GetTranslation();
+				Math::Vector3<double> translationAfter = objectAfter->GetWorldTransform().GetTranslation();
+				CHECK(translationAfter.X == translationBefore.X && translationAfter.Y == translationBefore.Y &&
+					translationAfter.Z == translationBefore.Z);
+				//Storage is outside any world.
+				CHECK(objectAfter->GetWorld() == (objectBefore->GetWorld() ? game->FindFirstChild("Workspace") : nullptr));
+			}
+			if (before->IsA<HingeConstraint>()) {
+				HingeConstraint* hingeBefore = static_cast<HingeConstraint*>(before);
+				HingeConstraint* hingeAfter = static_cast<HingeConstraint*>(after);
+				//References point into the loaded tree, not back at the originals.
+				CHECK(hingeAfter->Attachment1.Get() == counterpart(hingeBefore->Attachment1.Get(), place.game, game));
+				if (hingeBefore->Attachment0.Get() == place.hiddenChild) {
+					CHECK(hingeAfter->Attachment0.Get() == nullptr);
+				} else {
+					CHECK(hingeAfter->Attachment0.Get() == counterpart(hingeBefore->Attachment0.Get(), place.game, game));
+					CHECK(hingeAfter->Attachment0.Get()->Parent == after->Parent);
+				}
+			}
+		}
+		place.game->Destroy();
+		game->Destroy();
+	}
+
+	void testNonArchivable() {
+		std::printf("NonArchivable\n");
+		Place place = buildPlace(3);
+		std::vector<std::byte> bytes = PlaceWriter::Write({ place.game });
+		PlaceReader reader(bytes.data(), bytes.size());
+		CHECK(reader.FindInstance(place.hidden->Id) == PlaceFormat::NoIndex);
+		CHECK(reader.FindInstance(place.hiddenChild->Id) == PlaceFormat::NoIndex);
+		Instance* game = reader.Load(nullptr)[0];
+		CHECK(game->FindFirstDescendantByPath("Workspace.Hidden") == nullptr);
+		CHECK(game->FindFirstChild("Workspace")->Children.size() == 3);
+
+		//A non-Archivable root writes an empty place.
+		std::vector<std::byte> empty = PlaceWriter::Write({ place.hidden });
+		PlaceReader emptyReader(empty.data(), empty.size());
+		CHECK(emptyReader.GetInstanceCount() == 0);
+		CHECK(emptyReader.Load(nullptr).empty());
+		place.game->Destroy();
+		game->Destroy();
+	}
+
+	void testMalformed() {
+		std::printf("Malformed\n");
+		Place place = buildPlace(10);
+		const std::vector<std::byte> bytes = PlaceWriter::Write({ place.game });
+		std::unique_ptr<Engine> engine = std::make_unique<Engine>();
+		const size_t liveBefore = engine->GetInstanceIndex().GetCount();
+
+		//Truncated: rejected before anything is read.
+		CHECK(throwsRuntimeError([&]() { PlaceReader reader(bytes.data(), bytes.size() - 1); }));
+		CHECK(throwsRuntimeError([&]() { PlaceReader reader(bytes.data(), sizeof(PlaceFormat::Header) / 2); }));
+
+		//The last instance names a class that is not in the file: found once everything before it was created.
+		std::vector<std::byte> badClass = bytes;
+		{
+			const PlaceFormat::Header* header = reinterpret_cast<const PlaceFormat::Header*>(badClass.data());
+			PlaceFormat::InstanceEntry* entries = reinterpret_cast<PlaceFormat::InstanceEntry*>(badClass.data() + header->instanceTableOffset);
+			entries[header->instanceCount - 1].classIndex = 0x7fffffff;
+		}
+		CHECK(throwsRuntimeError([&]() { PlaceReader(badClass.data(), badClass.size()).Load(engine.get()); }));
+		CHECK(engine->GetInstanceIndex().GetCount() == liveBefore);
+
+		//A property column past the end of the file: found while applying properties, after every instance exists.
+		std::vector<std::byte> badColumn = bytes;
+		{
+			const PlaceFormat::Header* header = reinterpret_cast<const PlaceFormat::Header*>(badColumn.data());
+			const PlaceFormat::ClassEntry* classes = reinterpret_cast<const PlaceFormat::ClassEntry*>(badColumn.data() + header->classTableOffset);
+			for (uint32_t c = 0; c < header->classCount; c++) {
+				if (classes[c].instanceCount > 0 && classes[c].propertyCount > 0) {
+					PlaceFormat::PropertyEntry* props = reinterpret_cast<PlaceFormat::PropertyEntry*>(badColumn.data() + classes[c].propertiesOffset);
+					props[0].dataOffset = badColumn.size();
+					break;
+				}
+			}
+		}
+		CHECK(throwsRuntimeError([&]() { PlaceReader(badColumn.data(), badColumn.size()).Load(engine.get()); }));
+		CHECK(engine->GetInstanceIndex().GetCount() == liveBefore);
+
+		//A parent after its child breaks pre-order, which streaming relies on to find subtrees.
+		std::vector<std::byte> badOrder = bytes;
+		{
+			const PlaceFormat::Header* header = reinterpret_cast<const PlaceFormat::Header*>(badOrder.data());
+			PlaceFormat::InstanceEntry* entries = reinterpret_cast<PlaceFormat::InstanceEntry*>(badOrder.data() + header->instanceTableOffset);
+			entries[1].parent = header->instanceCount - 1;
+		}
+		CHECK(throwsRuntimeError([&]() {
+			std::make_shared<PlaceReader>(badOrder.data(), badOrder.size())->LoadStreamed(engine.get());
+		}));
+		CHECK(engine->GetInstanceIndex().GetCount() == liveBefore);
+
+		//The intact file still loads into the same engine.
+		Instance* game = PlaceReader(bytes.data(), bytes.size()).Load(engine.get())[0];
+		CHECK(engine->GetInstanceIndex().GetCount() > liveBefore);
+		place.game->Destroy();
+		game->Destroy();
+	}
+
+	void testStreamed() {
+		std::printf("Streamed\n");
+		Place place = buildPlace(20);
+		std::vector<std::byte> bytes = PlaceWriter::Write({ place.game });
+		std::shared_ptr<PlaceReader> reader = std::make_shared<PlaceReader>(bytes.data(), bytes.size());
+		Instance* game = reader->LoadStreamed(nullptr)[0];
+		Instance* workspace = game->Children[0];
+		Instance* storage = game->Children[1];
+		CHECK(game->IsSubtreeLoaded());
+		CHECK(!workspace->IsSubtreeLoaded() && workspace->Children.empty());
+		CHECK(!storage->IsSubtreeLoaded() && storage->Children.empty());
+
+		//Workspace first: its hinges refer into Storage, which is not there yet.
+		workspace->LoadSubtree();
+		Instance* found = workspace->FindFirstDescendantByPath("Model0.Part.Hinge");
+		CHECK(found && found->IsA<HingeConstraint>());
+		if (!found || !found->IsA<HingeConstraint>()) {
+			return;
+		}
+		HingeConstraint* hinge = static_cast<HingeConstraint*>(found);
+		CHECK(hinge->Attachment0.Get() == workspace->FindFirstDescendantByPath("Model0.Part.Attachment"));
+		CHECK(hinge->Attachment1.Get() == nullptr);
+
+		//Storage arriving patches the pending references.
+		int added = 0;
+		MulticastEvent<Instance*, Instance*>::Connection connection = game->DescendantAdded.Connect([&](Instance*, Instance*) { added++; });
+		Instance* spare = storage->FindFirstChild("Spare");
+		CHECK(spare != nullptr && storage->IsSubtreeLoaded() && added == 1);
+		CHECK(hinge->Attachment1.Get() == spare);
+		for (Instance* descendant : workspace->GetDescendants()) {
+			if (descendant->IsA<HingeConstraint>()) {
+				CHECK(static_cast<HingeConstraint*>(descendant)->Attachment1.Get() == spare);
+			}
+		}
+		connection.Disconnect();
+
+		//The streamed tree matches an eager load of the same place.
+		Instance* eager = PlaceReader(bytes.data(), bytes.size()).Load(nullptr)[0];
+		CHECK(eager->GetDescendants().size() == game->GetDescendants().size());
+		place.game->Destroy();
+		game->Destroy();
+		eager->Destroy();
+	}
+}
+
+int main() {
+	Reflection::registerAllClasses();
+	testRoundTrip();
+	testNonArchivable();
+	testMalformed();
+	testStreamed();
+	if (failures > 0) {
+		std::printf("%d check(s) failed\n", failures);
+		return 1;
+	}
+	std::printf("All place file tests passed\n");
+	return 0;
+}
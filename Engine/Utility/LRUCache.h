@@ -1,10 +1,78 @@
 #pragma once
 
 #include <cinttypes>
+#include <cstddef>
+#include <functional>
+#include <list>
 #include <unordered_map>
+#include <utility>
 
-template<typename KeyType, typename ValueType>
+/// Fixed-capacity map that evicts the least recently used entry once full. Find and Insert both count
+/// as a use. Entries live in a list ordered by recency, with a hash map from key to list node, so every
+/// operation is O(1). Not thread-safe.
+template<typename KeyType, typename ValueType, typename Hash = std::hash<KeyType>>
 class LRUCache {
 public:
-   
-};
\ No newline at end of file
+    explicit LRUCache(size_t _capacity) : capacity(_capacity) {
+        lookup.reserve(capacity);
+    }
+
+    /// The value cached for key, or nullptr. Marks the entry as most recently used.
+    ValueType* Find(const KeyType& key) {
+        auto it = lookup.find(key);
+        if (it == lookup.end()) {
+            return nullptr;
+        }
+        entries.splice(entries.begin(), entries, it->second);
+        return &it->second->second;
+    }
+
+    /// Caches value under key, replacing any previous value, and evicts the least recently used entry if full.
+    void Insert(const KeyType& key, ValueType value) {
+        auto it = lookup.find(key);
+        if (it != lookup.end()) {
+            it->second->second = std::move(value);
+            entries.splice(entries.begin(), entries, it->second);
+            return;
+        }
+        if (capacity == 0) {
+            return;
+        }
+        if (entries.size() >= capacity) {
+            //Reuse the evicted node rather than freeing one and allocating another.
+            auto last = std::prev(entries.end());
+            lookup.erase(last->first);
+            last->first = key;
+            last->second = std::move(value);
+            entries.splice(entries.begin(), entries, last);
+        } else {
+            entries.emplace_front(key, std::move(value));
+        }
+        lookup.emplace(key, entries.begin());
+    }
+
+    bool Erase(const KeyType& key) {
+        auto it = lookup.find(key);
+        if (it == lookup.end()) {
+            return false;
+        }
+        entries.erase(it->second);
+        lookup.erase(it);
+        return true;
+    }
+
+    void Clear() {
+        entries.clear();
+        lookup.clear();
+    }
+
+    size_t GetSize() const { return entries.size(); }
+    size_t GetCapacity() const { return capacity; }
+
+private:
+    using Entry = std::pair<KeyType, ValueType>;
+
+    size_t capacity;
+    std::list<Entry> entries;
+    std::unordered_map<KeyType, typename std::list<Entry>::iterator, Hash> lookup;
+};
@@ -10,9 +10,9 @@ using namespace std;
 int main() {
 	Reflection::registerAllClasses();
 
-	for (auto& classEntry : Reflection::registry.classes) {
-		cout << "Found class \"" << classEntry.first << "\":" << endl;
-		for (auto& propEntry : classEntry.second->properties) {
+	for (Reflection::Class* cls : Reflection::GetRegistry().GetClasses()) {
+		cout << "Found class \"" << cls->className << "\":" << endl;
+		for (auto& propEntry : cls->properties) {
 			cout << "\t" << propEntry.type 
 				<< " " << propEntry.name 
 				<< "; setter (" << (propEntry.setter != nullptr ? "yes" : "no")
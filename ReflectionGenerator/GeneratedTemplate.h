@@ -1,8 +1,10 @@
 #pragma once
 #include <typeinfo>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include "Instance/Reflection.h"
+#include "Instance/InstancePool.h"
 
 class System;
 class Instance;
@@ -11,46 +13,14 @@ class Engine;
 
 namespace Reflection {
 	inline Instance* instantiate_{{classSanitizedName}}(Engine* engine);
+	inline void destroy_{{classSanitizedName}}(Instance* inst);
 	inline ::std::shared_ptr<Instance> instantiateShared_{{classSanitizedName}}(Engine* engine);
 
+	//Perfect-hash property lookups, indexing into reflected_{{classSanitizedName}}.propertyTable.properties
+{{propertyHashTables}}
 
-	//Class runtime reflection data
-	inline static Class reflected_{{classSanitizedName}} = {
-		//Class name
-		"{{className}}",
-		//Class hash id
-		{{classId}},
-		{
-			//	Name, Type, Id, Flags, TypeFlags, Setter, Getter
-{{propDefs}}
-		},
-		{
-			//events
-{{eventDefs}}
-		},
-		{
-			//methods
-{{methodDefs}}
-		},
-		::std::function<Instance * (Engine*)>(&instantiate_{{classSanitizedName}}),
-		::std::function<::std::shared_ptr<Instance>(Engine*)>(&instantiateShared_{{classSanitizedName}}),
-		{
-			//public base classes
-{{publicBases}}
-		},
-		{
-			//protected base classes
-{{protectedBases}}
-		},
-		{
-			//private base classes
-{{privateBases}}
-		},
-		{
-			//derived classes
-{{derivedClasses}}
-		}
-	};
+	//Class runtime reflection data. Defined by REFLECTION_END(), once the class and its wrappers are complete.
+	extern Class reflected_{{classSanitizedName}};
 }
 
 #undef REFLECTION
@@ -66,12 +36,7 @@ public:\
 	static Reflection::Class& StaticClass() { \
 		 return Reflection::reflected_{{classSanitizedName}}; \
 	} \
-	struct ClassRegistrar { \
-		template<typename T> \
-		ClassRegistrar(T* inst) { \
-			Reflection::TrySetClass(inst, &StaticClass()); \
-		} \
-	} _classRegistrar{this}; \
+{{classGetter}} \
 public: \
 {{memberIds}} \
 {{raisePropChangedMethod}} \
@@ -84,11 +49,15 @@ private: \
 #define REFLECTION_END() \
 namespace Reflection { \
 {{wrapperFunctions}} \
+{{typedAccessors}} \
+{{instantiateFunctions}} \
+{{propDefs}} \
+{{eventDefs}} \
+{{baseClassDefs}} \
+{{propertyTableDef}} \
+{{classDef}} \
 	inline void register_{{classSanitizedName}}() { \
-		Reflection::GetRegistry().classes.insert({ "{{className}}", &Reflection::reflected_{{classSanitizedName}} }); \
-		Reflection::GetRegistry().classesById.insert({ {{classId}}, &Reflection::reflected_{{classSanitizedName}} }); \
-{{propResolvers}} \
+		Reflection::GetRegistry().Register(&reflected_{{classSanitizedName}}); \
 	} \
-{{instantiateFunctions}} \
 } \
 
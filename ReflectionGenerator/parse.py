@@ -8,7 +8,9 @@ from pathlib import Path
 import json
 from json import JSONEncoder
 import sys
-from datetime import datetime
+import hashlib
+import pickle
+from concurrent.futures import ProcessPoolExecutor
 
 CPP = Language(tscpp.language())
 parser = Parser(CPP)
@@ -28,6 +30,58 @@ def fnv1a_64(data):
 
     return hash_value
 
+MASK_64 = 0xFFFFFFFFFFFFFFFF
+
+#must match Reflection::mixHash() in Instance/Reflection.h
+def mix_hash(key, seed):
+	h = (key ^ (seed * 0x9E3779B97F4A7C15)) & MASK_64
+	h ^= h >> 33
+	h = (h * 0xFF51AFD7ED558CCD) & MASK_64
+	h ^= h >> 33
+	h = (h * 0xC4CEB9FE1A85EC53) & MASK_64
+	h ^= h >> 33
+	return h
+
+def next_pow2(n):
+	p = 1
+	while p < n:
+		p *= 2
+	return p
+
+PERFECT_HASH_EMPTY = 0xFFFF
+
+def build_perfect_hash(pairs):
+	#hash and displace: keys are split into buckets, and each bucket (largest first) searches for a seed
+	#that sends all of its keys to free slots. keys must be unique. returns (seeds, slots).
+	slot_count = next_pow2(max(1, len(pairs) + len(pairs) // 4))
+	bucket_count = next_pow2(max(1, (len(pairs) + 1) // 2))
+	while True:
+		slot_mask = slot_count - 1
+		buckets = [[] for _ in range(bucket_count)]
+		for key, value in pairs:
+			buckets[mix_hash(key, 0) & (bucket_count - 1)].append((key, value))
+
+		seeds = [0] * bucket_count
+		slots = [PERFECT_HASH_EMPTY] * slot_count
+		failed = False
+		for bucket_index in sorted(range(bucket_count), key=lambda b: -len(buckets[b])):
+			bucket = buckets[bucket_index]
+			if len(bucket) == 0:
+				break
+			for seed in range(1, 1 << 16):
+				positions = [mix_hash(key, seed) & slot_mask for key, _ in bucket]
+				if len(set(positions)) == len(positions) and all(slots[p] == PERFECT_HASH_EMPTY for p in positions):
+					break
+			else:
+				failed = True
+				break
+			seeds[bucket_index] = seed
+			for position, (key, value) in zip(positions, bucket):
+				slots[position] = value
+		if not failed:
+			return seeds, slots
+		slot_count *= 2
+
 ignored_attributes = [ "argNames", "reflect" ]
 
 class ReflectedProperty:
@@ -152,8 +206,8 @@ class ReflectedMethod:
 			if self.is_setter:
 				return f"inline void {wrapped_func_name}(void* obj, void* value) {{ reinterpret_cast<{parent_name}*>(obj)->{self.name}(*reinterpret_cast<{prop.prop_type}*>(value)); }}"
 			elif self.is_getter:
-				#we need to handle the case of the return type being a pointer or not...
-				return f"inline void* {wrapped_func_name}(void* obj) {{ {prop.prop_type} value = reinterpret_cast<{parent_name}*>(obj)->{self.name}(); return reinterpret_cast<void*>(&value); }}"
+				#getters may return by value, so the result is kept in per-thread storage that outlives the call
+				return f"inline void* {wrapped_func_name}(void* obj) {{ thread_local std::optional<{prop.prop_type}> value; value.emplace(reinterpret_cast<{parent_name}*>(obj)->{self.name}()); return reinterpret_cast<void*>(&*value); }}"
 		else:
 			#todo: how should this work, exactly? hmm... probably just gonna do straight lua_State* shit.
 			pass
@@ -205,6 +259,13 @@ class ReflectedClass:
 				return prop
 		return None
 	def resolve(self):
+		#Derived properties have no field to fall back on, so they are only writable through a Set<Prop> method
+		for method in self.methods:
+			if method.has_flag("Derived") and method.is_getter:
+				prop = method.get_associated_prop()
+				has_setter = any(other.is_setter and other.associated_prop_name == method.associated_prop_name for other in self.methods)
+				if prop and not has_setter and "ReadOnly" not in prop.flags:
+					prop.flags.append("ReadOnly")
 		#assign getters and setters if found
 		for method in self.methods:
 			if method.name[0:3] == "Set":
@@ -218,6 +279,34 @@ class ReflectedClass:
 				prop = self.get_prop(prop_name)
 				if prop:
 					prop.getter = f"&{method.get_wrapped_func_name()}"
+	def get_base_classes(self, all_classes):
+		#reflected base classes only, e.g. BaseInstance<T> is skipped
+		result = []
+		for base_name in self.public_base_classes + self.protected_base_classes + self.private_base_classes:
+			for other in all_classes:
+				if other.name == base_name:
+					result.append(other)
+					break
+		return result
+	def get_flattened_props(self, all_classes):
+		#every property visible on this class as (declaring class, index in its props), base classes first
+		result = []
+		visited = set()
+		def visit(class_info):
+			if class_info.name in visited:
+				return
+			visited.add(class_info.name)
+			for base in class_info.get_base_classes(all_classes):
+				visit(base)
+			for i in range(0, len(class_info.props)):
+				result.append((class_info, i))
+		visit(self)
+		return result
+	def is_instance_class(self, all_classes):
+		#true for Instance and everything reflected that derives from it
+		if self.get_fully_qualified_name() == "Instance":
+			return True
+		return any(base.is_instance_class(all_classes) for base in self.get_base_classes(all_classes))
 	def get_primary_base(self, all_classes):
 		if len(self.public_base_classes) == 0:
 			return None
@@ -230,9 +319,8 @@ class ReflectedClass:
 
 class ReflectionEncoder(JSONEncoder):
 	def default(self, o):
-		d = o.__dict__
-		if 'parent' in d:
-			del d['parent']
+		d = dict(o.__dict__)
+		d.pop('parent', None)
 		return d
 		
 
@@ -385,8 +473,7 @@ def handle_function(current_class, node):
 			if not current_class.get_prop(prop_name):
 				prop_flags = reflect_flags.copy()
 				prop_flags.remove("Derived")
-				if "ReadOnly" not in prop_flags:
-					prop_flags.append("ReadOnly")
+				#becomes ReadOnly in resolve() unless the class also declares Set<Prop>
 				current_class.props.append(ReflectedProperty(current_class, return_type, prop_name, prop_flags, attributes))
 
 def is_event_type(type_identifier_str):
@@ -559,39 +646,69 @@ def iterate_headers(root_dir, ignore_paths = None):
 					continue
 				yield filepath
 
-def generate_prop_def_text(prop_info):
-	flags = ""
-	if len(prop_info.flags) == 0:
-		flags = "DefaultPropFlags"
-	else:
-		num_flags = len(prop_info.flags)
-		for i in range(0, num_flags):
-			if i < num_flags - 1:
-				flags += f"PropFlags::{prop_info.flags[i]} | "
-			else:
-				flags += f"PropFlags::{prop_info.flags[i]}"
+def get_prop_type_flags(prop_type):
+	t = prop_type.strip()
+	if t.endswith('*'):
+		return "RawPointer"
+	if t.startswith("InstanceRef<"):
+		return "InstanceRef"
+	if t.startswith(("std::shared_ptr", "std::unique_ptr", "std::weak_ptr")):
+		return "SmartPointer"
+	if t.startswith("std::vector"):
+		return "Vector"
+	if t.startswith(("std::map", "std::unordered_map")):
+		return "Map"
+	if t.startswith("std::array"):
+		return "Array"
+	return "None"
+
+def generate_prop_def_text(class_info, prop_info, index):
+	#Explicit flags add to the defaults, like the *PropFlags presets in Reflection.h.
+	#Transient is generator-only and keeps a property out of place files by dropping Storable.
+	explicit_flags = [f for f in prop_info.flags if f != "Transient"]
+	flags = "PropFlags::Serializable" if "Transient" in prop_info.flags else "DefaultPropFlags"
+	for flag in explicit_flags:
+		flags += f" | PropFlags::{flag}"
 
 	access_level = "Public"
 	minimum_context = "Client"
-	return f'\t\t\t{{ "{prop_info.name}", "{prop_info.prop_type}", {prop_info.hash}ULL, {flags}, PropTypeFlags::None, AccessLevel::{access_level}, Lua::StateContext::{minimum_context}, nullptr, nullptr }}'
-
-def generate_prop_defs_text(class_info):
-	result = ""
-	num_props = len(class_info.props)
-	for i in range(0, num_props):
-		prop_info = class_info.props[i]
-		if i < num_props - 1:
-			result += generate_prop_def_text(prop_info) + ",\n"
-		else:
-			result += generate_prop_def_text(prop_info)
+	type_flags = get_prop_type_flags(prop_info.prop_type)
+	sanitized_name = class_info.get_sanitized_name()
+	#the wrapper for an explicit Set/Get method and the default wrapper share a name, one of them always exists
+	setter = f"&wrap_{sanitized_name}_Set{prop_info.name}"
+	getter = f"&wrap_{sanitized_name}_Get{prop_info.name}"
+	accessor = ""
+	if has_typed_accessors(class_info):
+		suffix = f"{sanitized_name}_{prop_info.name}"
+		offset = f", &fieldOffset_{suffix}" if is_field_prop(class_info, prop_info) else ""
+		accessor = f", ::Reflection::MakePropertyAccessor(accessor_{suffix}{offset})"
+	return f'\t\t{{ "{prop_info.name}", "{prop_info.prop_type}", {prop_info.hash}ULL, {index}, {flags}, PropTypeFlags::{type_flags}, AccessLevel::{access_level}, Lua::StateContext::{minimum_context}, {setter}, {getter}{accessor} }}'
+
+def generate_prop_defs_text(class_info, all_classes):
+	if len(class_info.props) == 0:
+		return ""
+	sanitized_name = class_info.get_sanitized_name()
+	indices = { prop_info.name: index for owner, prop_info, index in get_dense_prop_indices(class_info, all_classes) if owner == class_info }
+	#constinit rather than constexpr: Registry::Finalize() fills in the field offsets
+	result = f"\tinline constinit Property properties_{sanitized_name}[] = {{ \\\n"
+	result += ", \\\n".join(generate_prop_def_text(class_info, prop_info, indices[prop_info.name]) for prop_info in class_info.props)
+	result += " \\\n\t}; \\\n"
 	return result
-def generate_member_ids_text(class_info):
+def generate_member_ids_text(class_info, all_classes):
 	result = ""
 	for prop_info in class_info.props:
 			result += f"\tstatic constexpr uint64_t prop_{prop_info.name} = {prop_info.hash}ULL; \\\n"
+	for owner, prop_info, index in get_dense_prop_indices(class_info, all_classes):
+		if owner == class_info:
+			result += f"\tstatic constexpr uint32_t propIndex_{prop_info.name} = {index}; \\\n"
 	for event_info in class_info.events:
 			result += f"\tstatic constexpr uint64_t event_{event_info.name} = {event_info.hash}ULL; \\\n"
+	emitted_methods = set()
 	for method_info in class_info.methods:
+			#overloads share a single id
+			if method_info.name in emitted_methods:
+				continue
+			emitted_methods.add(method_info.name)
 			result += f"\tstatic constexpr uint64_t method_{method_info.name} = {method_info.hash}ULL; \\\n"
 	return result
 def generate_prop_changed_handlers_text(class_info):
@@ -601,40 +718,35 @@ def generate_prop_changed_handlers_text(class_info):
 		if call:
 			result += call
 	return result
-def generate_event_def_text(event_info):
-	event_args = ""
-	num_args = len(event_info.args)
-	for i in range(0, num_args):
-		arg = event_info.args[i]
-		if i < num_args - 1:
-			event_args += f"{{ \"{arg.type}\", \"{arg.name}\" }}, "
-		else:
-			event_args += f"{{ \"{arg.type}\", \"{arg.name}\" }}"
+def generate_event_def_text(class_info, event_info):
+	args = "{}"
+	if len(event_info.args) > 0:
+		args = f"eventArgs_{class_info.get_sanitized_name()}_{event_info.name}"
 	access_level = "Public"
 	minimum_context = "Client"
-	return f'\t\t\t{{ "{event_info.name}", {{{event_args}}}, {event_info.hash}ULL, AccessLevel::{access_level}, Lua::StateContext::{minimum_context} }}'
+	return f'\t\t{{ "{event_info.name}", {args}, {event_info.hash}ULL, AccessLevel::{access_level}, Lua::StateContext::{minimum_context} }}'
 def generate_event_defs_text(class_info):
+	if len(class_info.events) == 0:
+		return ""
+	sanitized_name = class_info.get_sanitized_name()
 	result = ""
-	num_events = len(class_info.events)
-	for i in range(0, num_events):
-		event_info = class_info.events[i]
-		if i < num_events - 1:
-			result += generate_event_def_text(event_info) + ",\n"
-		else:
-			result += generate_event_def_text(event_info)
+	for event_info in class_info.events:
+		if len(event_info.args) == 0:
+			continue
+		event_args = ", ".join(f'{{ "{arg.type}", "{arg.name}" }}' for arg in event_info.args)
+		result += f"\tinline constexpr Argument eventArgs_{sanitized_name}_{event_info.name}[] = {{ {event_args} }}; \\\n"
+	result += f"\tinline constexpr Event events_{sanitized_name}[] = {{ \\\n"
+	result += ", \\\n".join(generate_event_def_text(class_info, event_info) for event_info in class_info.events)
+	result += " \\\n\t}; \\\n"
 	return result
-def generate_method_defs_text(class_info):
-	return ""
-def generate_class_refs_text(class_info, class_refs):
-	if len(class_refs) == 0:
-		return ""
+def generate_class_refs_text(class_refs):
+	return ", ".join(f"{fnv1a_64(f'class:{class_ref}')}ULL" for class_ref in class_refs)
+def generate_base_class_defs_text(class_info):
+	sanitized_name = class_info.get_sanitized_name()
 	result = ""
-	for i in range(0, len(class_refs)):
-		class_hash = fnv1a_64(f"class:{class_refs[i]}")
-		if i < len(class_refs) - 1:
-			result += f"{class_hash}ULL, "
-		else:
-			result += f"{class_hash}ULL"
+	for kind, class_refs in [("public", class_info.public_base_classes), ("protected", class_info.protected_base_classes), ("private", class_info.private_base_classes)]:
+		if len(class_refs) > 0:
+			result += f"\tinline constexpr uint64_t {kind}Bases_{sanitized_name}[] = {{ {generate_class_refs_text(class_refs)} }}; \\\n"
 	return result
 
 def generate_wrapper_functions_text(class_info):
@@ -652,63 +764,212 @@ def generate_wrapper_functions_text(class_info):
 			method_wrappers += "\t" + getter_wrapper + " \\\n"
 	return method_wrappers
 
-def generate_prop_resolvers_text(class_info):
-	prop_setter_getter_resolution = ""
+def is_field_prop(class_info, prop_info):
+	#Derived properties come from a getter and have no storage of their own
+	for method in class_info.methods:
+		if method.has_flag("Derived") and method.get_associated_prop() == prop_info:
+			return False
+	return True
+
+def has_typed_accessors(class_info):
+	#the trampolines cast from ::Instance*, which interfaces don't derive from
+	return not ("reflect" in class_info.flags and "Interface" in class_info.flags["reflect"])
+
+def generate_typed_accessors_text(class_info):
+	if not has_typed_accessors(class_info):
+		return ""
+	result = ""
 	sanitized_name = class_info.get_sanitized_name()
 	full_name = class_info.get_fully_qualified_name()
-	for method in class_info.methods:
-		wrapper = method.generate_wrapper()
-		if wrapper:
-			prop_name = method.associated_prop_name
-			if method.is_setter:
-				prop_setter_getter_resolution += f"\t\treflected_{sanitized_name}.ResolvePropSetter({full_name}::prop_{prop_name}, (void*)&wrap_{sanitized_name}_Set{prop_name}); \\\n"
-			if method.is_getter:
-				prop_setter_getter_resolution += f"\t\treflected_{sanitized_name}.ResolvePropGetter({full_name}::prop_{prop_name}, (void*)&wrap_{sanitized_name}_Get{prop_name}); \\\n"
-	
-	for prop_info in class_info.props:
-		setter_wrapper, getter_wrapper = prop_info.generate_default_getter_setter()
-		if setter_wrapper:
-			prop_setter_getter_resolution += f"\t\treflected_{sanitized_name}.ResolvePropSetter({full_name}::prop_{prop_info.name}, (void*)&wrap_{sanitized_name}_Set{prop_info.name}); \\\n"
-		if getter_wrapper:
-			prop_setter_getter_resolution += f"\t\treflected_{sanitized_name}.ResolvePropGetter({full_name}::prop_{prop_info.name}, (void*)&wrap_{sanitized_name}_Get{prop_info.name}); \\\n"
-	return prop_setter_getter_resolution
+	for prop in class_info.props:
+		suffix = f"{sanitized_name}_{prop.name}"
+		if is_field_prop(class_info, prop):
+			result += f"\tinline uint32_t fieldOffset_{suffix}() {{ return ::Reflection::instanceFieldOffset(&{full_name}::{prop.name}); }} \\\n"
+			result += f"\tinline {prop.prop_type} typedGet_{suffix}(const ::Instance* obj) {{ return static_cast<const {full_name}*>(obj)->{prop.name}; }} \\\n"
+		else:
+			#getters aren't necessarily const
+			result += f"\tinline {prop.prop_type} typedGet_{suffix}(const ::Instance* obj) {{ return const_cast<{full_name}*>(static_cast<const {full_name}*>(obj))->Get{prop.name}(); }} \\\n"
+		setter = "nullptr"
+		if not prop.has_flag("ReadOnly"):
+			result += f"\tinline void typedSet_{suffix}(::Instance* obj, const {prop.prop_type}& value) {{ static_cast<{full_name}*>(obj)->Set{prop.name}(value); }} \\\n"
+			setter = f"&typedSet_{suffix}"
+		result += f"\tinline constexpr TypedAccessor<{prop.prop_type}> accessor_{suffix} = {{ &typedGet_{suffix}, {setter} }}; \\\n"
+	return result
+
+def is_instantiable(class_info):
+	return not ("reflect" in class_info.flags and ("Interface" in class_info.flags["reflect"] or "Abstract" in class_info.flags["reflect"]))
 
 def generate_instantiate_functions_text(class_info):
 	sanitized_name = class_info.get_sanitized_name()
 	full_name = class_info.get_fully_qualified_name()
-	if "reflect" in class_info.flags and ("Interface" in class_info.flags["reflect"] or "Abstract" in class_info.flags["reflect"]):
+	if not is_instantiable(class_info):
 		return f"""	inline ::Instance* instantiate_{sanitized_name}(Engine* engine) {{ \\
 		return nullptr; \\
 	}} \\
 	inline ::std::shared_ptr<::Instance> instantiateShared_{sanitized_name}(Engine* engine) {{ \\
 		return nullptr; \\
-	}}"""
-	elif "reflect" in class_info.flags and "Engine" in class_info.flags["reflect"]:
-		return f"""	inline ::Instance* instantiate_{sanitized_name}(Engine* engine) {{ \\
-		return (::Instance*)new {full_name}(nullptr); \\
 	}} \\
-	inline ::std::shared_ptr<::Instance> instantiateShared_{sanitized_name}(Engine* engine) {{ \\
-		return ::std::static_pointer_cast<::Instance>(::std::make_shared<{full_name}>(nullptr)); \\
+	inline void destroy_{sanitized_name}(::Instance* inst) {{ \\
+		throw std::runtime_error("Cannot destroy an instance of abstract class {full_name}"); \\
 	}}"""
-	else:
-		return f"""	inline ::Instance* instantiate_{sanitized_name}(Engine* engine) {{ \\
-		return (::Instance*)new {full_name}(engine); \\
+
+	#Engine-flagged classes are constructed without an owning engine.
+	engine_arg = "engine"
+	if "reflect" in class_info.flags and "Engine" in class_info.flags["reflect"]:
+		engine_arg = "nullptr"
+	#Default names are assigned here, where the most derived class is known, from the interned ClassName().
+	return f"""	inline ::Instance* instantiate_{sanitized_name}(Engine* engine) {{ \\
+		{full_name}* instance = ::Reflection::PoolNew<{full_name}>({engine_arg}); \\
+		instance->Name = {full_name}::ClassName(); \\
+		return (::Instance*)instance; \\
+	}} \\
+	inline void destroy_{sanitized_name}(::Instance* inst) {{ \\
+		::Reflection::PoolDelete<{full_name}>(inst); \\
 	}} \\
 	inline ::std::shared_ptr<::Instance> instantiateShared_{sanitized_name}(Engine* engine) {{ \\
-		return ::std::static_pointer_cast<::Instance>(::std::make_shared<{full_name}>(engine)); \\
+		return ::std::shared_ptr<::Instance>(instantiate_{sanitized_name}(engine), &destroy_{sanitized_name}); \\
 	}}"""
 
-def generate_raise_prop_changed_method_text(class_info):
-	if "reflect" in class_info.flags and "Interface" in class_info.flags["reflect"]:
+def generate_class_getter_text(class_info, all_classes):
+	#Instances report their most derived class through this override rather than storing a pointer per object.
+	if not class_info.is_instance_class(all_classes):
+		return ""
+	if class_info.get_fully_qualified_name() == "Instance":
+		return "\tvirtual Reflection::Class* GetClass() const { return &StaticClass(); }"
+	return "\tReflection::Class* GetClass() const override { return &StaticClass(); }"
+
+def generate_perfect_hash_text(name, pairs):
+	seeds, slots = build_perfect_hash(pairs)
+	seeds_text = ", ".join(str(seed) for seed in seeds)
+	slots_text = ", ".join(str(slot) for slot in slots)
+	return f"""\tinline constexpr uint32_t {name}Seeds[] = {{ {seeds_text} }};
+	inline constexpr uint16_t {name}Slots[] = {{ {slots_text} }};
+"""
+
+def get_property_hash_pairs(class_info, all_classes):
+	flattened = class_info.get_flattened_props(all_classes)
+	id_pairs = []
+	names = dict()
+	for i in range(0, len(flattened)):
+		owner, prop_index = flattened[i]
+		prop = owner.props[prop_index]
+		id_pairs.append((prop.hash, i))
+		#later (more derived) properties shadow base properties with the same name
+		names[prop.name] = i
+	name_pairs = [(fnv1a_64(name), i) for name, i in names.items()]
+	return id_pairs, name_pairs
+
+def generate_property_hash_tables_text(class_info, all_classes):
+	sanitized_name = class_info.get_sanitized_name()
+	id_pairs, name_pairs = get_property_hash_pairs(class_info, all_classes)
+	return generate_perfect_hash_text(f"propIds_{sanitized_name}", id_pairs) + generate_perfect_hash_text(f"propNames_{sanitized_name}", name_pairs)
+
+def generate_property_table_def_text(class_info, all_classes):
+	flattened = class_info.get_flattened_props(all_classes)
+	if len(flattened) == 0:
+		return ""
+	pointers = ", ".join(f"&properties_{owner.get_sanitized_name()}[{prop_index}]" for owner, prop_index in flattened)
+	return f"\tinline constexpr Property* const propertyTable_{class_info.get_sanitized_name()}[] = {{ {pointers} }}; \\\n"
+
+def generate_property_table_init_text(class_info, all_classes):
+	sanitized_name = class_info.get_sanitized_name()
+	id_pairs, name_pairs = get_property_hash_pairs(class_info, all_classes)
+	if len(id_pairs) == 0:
+		return ""
+	id_seeds, id_slots = build_perfect_hash(id_pairs)
+	name_seeds, name_slots = build_perfect_hash(name_pairs)
+	return f"""\t\t.propertyTable = {{ \\
+			.properties = propertyTable_{sanitized_name}, \\
+			.byId = {{ propIds_{sanitized_name}Seeds, propIds_{sanitized_name}Slots, {len(id_seeds) - 1}, {len(id_slots) - 1} }}, \\
+			.byName = {{ propNames_{sanitized_name}Seeds, propNames_{sanitized_name}Slots, {len(name_seeds) - 1}, {len(name_slots) - 1} }} \\
+		}} \\
+"""
+
+def generate_class_def_text(class_info, all_classes):
+	#designated initializers have to follow the member order of Reflection::Class
+	sanitized_name = class_info.get_sanitized_name()
+	full_name = class_info.get_fully_qualified_name()
+	fields = [f'\t\t.className = "{class_info.name}"', f"\t\t.id = {class_info.hash}ULL"]
+	if len(class_info.props) > 0:
+		fields.append(f"\t\t.properties = properties_{sanitized_name}")
+	if len(class_info.events) > 0:
+		fields.append(f"\t\t.events = events_{sanitized_name}")
+	fields.append(f"\t\t.constructor = &instantiate_{sanitized_name}")
+	fields.append(f"\t\t.sharedConstructor = &instantiateShared_{sanitized_name}")
+	for kind, class_refs in [("public", class_info.public_base_classes), ("protected", class_info.protected_base_classes), ("private", class_info.private_base_classes)]:
+		if len(class_refs) > 0:
+			fields.append(f"\t\t.{kind}BaseClasses = {kind}Bases_{sanitized_name}")
+	if is_instantiable(class_info):
+		fields.append(f"\t\t.pool = &::Reflection::GetInstancePool<{full_name}>")
+		fields.append(f"\t\t.destructor = &destroy_{sanitized_name}")
+	table = generate_property_table_init_text(class_info, all_classes)
+	if table:
+		fields.append(table.rstrip(" \\\n"))
+	immediate_mask = 0
+	for owner, prop_info, index in get_dense_prop_indices(class_info, all_classes):
+		if prop_info.has_flag("Immediate"):
+			immediate_mask |= 1 << index
+	if immediate_mask != 0:
+		fields.append(f"\t\t.immediateProps = {hex(immediate_mask)}ULL")
+	result = f"\tinline constinit Class reflected_{sanitized_name} = {{ \\\n"
+	result += ", \\\n".join(fields)
+	result += " \\\n"
+	result += "\t}; \\\n"
+	return result
+
+#dirty bitsets are a single uint64_t per instance
+max_flattened_props = 64
+
+def is_interface(class_info):
+	return "reflect" in class_info.flags and "Interface" in class_info.flags["reflect"]
+
+def get_reflected_ancestors(class_info, all_classes):
+	result = []
+	for base in class_info.get_base_classes(all_classes):
+		if base not in result:
+			result.append(base)
+		for ancestor in get_reflected_ancestors(base, all_classes):
+			if ancestor not in result:
+				result.append(ancestor)
+	return result
+
+def get_dense_prop_indices(class_info, all_classes):
+	#every property visible on the class with its dense index, which is its position in the flattened property table.
+	#base class properties come first, so a class and everything derived from it along the first base agree on indices.
+	flattened = class_info.get_flattened_props(all_classes)
+	if len(flattened) > max_flattened_props:
+		raise Exception(f"{class_info.get_fully_qualified_name()} has {len(flattened)} properties, the dirty bitset only holds {max_flattened_props}")
+	#raisePropChanged is not virtual: a setter declared on a base marks the bit from that base's own table, while the
+	#journal reads bits against the most derived class's. so every base's table has to be a prefix of this one, which
+	#only fails for properties reached through a second reflected base. interfaces raise nothing, so they are exempt
+	for ancestor in get_reflected_ancestors(class_info, all_classes):
+		if is_interface(ancestor):
+			continue
+		ancestor_flattened = ancestor.get_flattened_props(all_classes)
+		if flattened[:len(ancestor_flattened)] != ancestor_flattened:
+			raise Exception(f"{class_info.get_fully_qualified_name()} reaches the properties of {ancestor.get_fully_qualified_name()} through a base other than its first, "
+				f"so their change bits would not line up. Declare the properties on the first base, or make the other base an interface")
+	return [(owner, owner.props[prop_index], i) for i, (owner, prop_index) in enumerate(flattened)]
+
+def generate_raise_prop_changed_method_text(class_info, all_classes):
+	if is_interface(class_info):
 		return "\tvoid raisePropChanged(uint64_t propId) {}"
 	
 	handlers = generate_prop_changed_handlers_text(class_info)
+	#changed handlers run synchronously. the property's dirty bit is set for the engine's journal, which coalesces the
+	#event fan-out, unless the property asks to be Immediate, in which case the events fire right here as well
+	cases = ""
+	for owner, prop, index in get_dense_prop_indices(class_info, all_classes):
+		prop_id = f"{owner.get_fully_qualified_name()}::prop_{prop.name}"
+		if prop.has_flag("Immediate"):
+			cases += f"\t\tcase {prop_id}: firePropertyChanged(propId); markPropertyDirty(1ull << {index}); break; \\\n"
+		else:
+			cases += f"\t\tcase {prop_id}: recordPropertyChanged(propId, 1ull << {index}); break; \\\n"
 	return f"""\tvoid raisePropChanged(uint64_t propId) {{ \\
 {handlers}\
-		PropertyChanged.Fire(propId); \\
-		if (LuaPropertyChanged.HasAnyListeners()) {{ \\
-			const std::string& propName = StaticClass().GetPropName(propId); \\
-			LuaPropertyChanged.Fire(propName); \\
+		switch (propId) {{ \\
+{cases}\
+		default: break; \\
 		}} \\
 	}}"""
 
@@ -759,7 +1020,7 @@ def generate_accessors_text(class_info):
 			
 	return result
 
-def generate_header(template_path, target_dir, header_filename, class_info):
+def generate_header(template_path, target_dir, header_filename, class_info, all_classes):
 	output = ""
 	with open(template_path, "r") as template_file:
 		output = template_file.read()
@@ -779,19 +1040,19 @@ def generate_header(template_path, target_dir, header_filename, class_info):
 			main_base_class = class_info.private_base_classes[0]
 		replacements["mainBaseClassName"] = main_base_class
 
-		replacements["propDefs"] = generate_prop_defs_text(class_info)
-		replacements["memberIds"] = generate_member_ids_text(class_info)
-		replacements["raisePropChangedMethod"] = generate_raise_prop_changed_method_text(class_info)
-		replacements["eventDefs"] = generate_event_defs_text(class_info)
-		replacements["methodDefs"] = generate_method_defs_text(class_info)
-		replacements["publicBases"] = generate_class_refs_text(class_info, class_info.public_base_classes)
-		replacements["protectedBases"] = generate_class_refs_text(class_info, class_info.protected_base_classes)
-		replacements["privateBases"] = generate_class_refs_text(class_info, class_info.private_base_classes)
-		replacements["derivedClasses"] = generate_class_refs_text(class_info, class_info.derived_classes)
+		replacements["memberIds"] = generate_member_ids_text(class_info, all_classes)
+		replacements["classGetter"] = generate_class_getter_text(class_info, all_classes)
+		replacements["raisePropChangedMethod"] = generate_raise_prop_changed_method_text(class_info, all_classes)
 		replacements["wrapperFunctions"] = generate_wrapper_functions_text(class_info)
-		replacements["propResolvers"] = generate_prop_resolvers_text(class_info)
 		replacements["instantiateFunctions"] = generate_instantiate_functions_text(class_info)
+		replacements["propertyHashTables"] = generate_property_hash_tables_text(class_info, all_classes)
 		replacements["generatedAccessors"] = generate_accessors_text(class_info)
+		replacements["typedAccessors"] = generate_typed_accessors_text(class_info)
+		replacements["propDefs"] = generate_prop_defs_text(class_info, all_classes)
+		replacements["eventDefs"] = generate_event_defs_text(class_info)
+		replacements["baseClassDefs"] = generate_base_class_defs_text(class_info)
+		replacements["propertyTableDef"] = generate_property_table_def_text(class_info, all_classes)
+		replacements["classDef"] = generate_class_def_text(class_info, all_classes)
 			
 		for key in replacements:
 			# print("replacing", key, "with", replacements[key])
@@ -802,24 +1063,64 @@ def generate_header(template_path, target_dir, header_filename, class_info):
 	generated_filename = f"{base_filename}.generated{base_extension}"
 	generated_path = os.path.join(target_dir, generated_filename)
 
-	if os.path.exists(generated_path):
-		with open(generated_path, "r") as existing_file:
-			first_line = existing_file.readline()
-			if first_line.startswith("//Autogenerated at "):
-				timestamp_str = first_line.replace("//Autogenerated at ", "").strip()
-				try:
-					generated_time = datetime.strptime(timestamp_str, "%Y-%m-%d %H:%M:%S.%f")
-					header_mtime = datetime.fromtimestamp(os.path.getmtime(header_filename))
-					if header_mtime < generated_time:
-						return
-				except ValueError:
-					pass
+	#no timestamp in the output, so an unchanged header regenerates byte for byte and write_if_changed leaves it alone
+	return write_if_changed(generated_path, "//Autogenerated by ReflectionGenerator/parse.py, do not edit.\n" + output)
 
-	with open(generated_path, "w") as output_file:
-		output_file.write(f"//Autogenerated at {datetime.now()}\n")
-		output_file.write(output)
-		print(f"Wrote {generated_path}.")
+def write_if_changed(path, content):
+	#leaving unchanged outputs untouched keeps their mtime, so nothing that includes them recompiles
+	try:
+		with open(path, "r", newline="") as existing_file:
+			if existing_file.read() == content:
+				return False
+	except OSError:
+		pass
+	with open(path, "w", newline="") as output_file:
+		output_file.write(content)
+	print(f"Wrote {path}.")
+	return True
+
+def content_hash(data):
+	return hashlib.sha256(data).hexdigest()
+
+def generator_fingerprint():
+	#cached parse results are only valid for the parser that produced them
+	with open(os.path.abspath(__file__), "rb") as f:
+		return content_hash(f.read())
+
+def load_parse_cache(cache_path, fingerprint):
+	#the cache is disposable, anything wrong with it just means a full parse
+	try:
+		with open(cache_path, "rb") as f:
+			cache = pickle.load(f)
+		if cache.get("fingerprint") == fingerprint:
+			return cache["headers"]
+	except Exception:
+		pass
+	return dict()
+
+def save_parse_cache(cache_path, fingerprint, headers):
+	with open(cache_path, "wb") as f:
+		pickle.dump({ "fingerprint": fingerprint, "headers": headers }, f, protocol=pickle.HIGHEST_PROTOCOL)
 
+def parse_header(job):
+	#runs in a worker process, so it only gets plain data and hands back plain (picklable) classes
+	header_filename, source_code = job
+	# Hack to fix tree-sitter parsing of GP_EXPORT
+	source_code = source_code.replace(b"GP_EXPORT", b"")
+	tree = parser.parse(source_code)
+	classes = walk_tree(header_filename, tree, source_code)
+	for class_info in classes:
+		class_info.resolve()
+	return header_filename, classes
+
+#below this many changed headers a process pool costs more to start than it saves
+min_parallel_headers = 4
+
+def parse_headers(jobs):
+	if len(jobs) < min_parallel_headers:
+		return [parse_header(job) for job in jobs]
+	with ProcessPoolExecutor() as executor:
+		return list(executor.map(parse_header, jobs, chunksize=max(1, len(jobs) // (4 * (os.cpu_count() or 1)))))
 
 
 if __name__ == "__main__":
@@ -851,57 +1152,94 @@ if __name__ == "__main__":
 
 
 
-	all_classes = []
+	#every header is parsed before anything is generated, since inherited properties are flattened into
+	#each class's tables. the filename filter only limits which headers get regenerated.
+	#parse results are cached by header content, so only headers that changed since the last run are parsed again.
+	cache_path = os.path.join(generated_dir, "parse_cache.pickle")
+	fingerprint = generator_fingerprint()
+	cached_headers = load_parse_cache(cache_path, fingerprint)
+	header_entries = []
+	jobs = []
 	with open("parsed_headers.log", "w") as header_log:
 		for header in iterate_headers(".", ignore_paths):
 			header_filename = os.path.relpath(header, target_directory).replace('\\', '/')
-
-			if filenames and not any(fn in header_filename for fn in filenames):
-				continue
-
-			print(f"Parsing {header}")
 			header_log.write(f"{header}\n")
-			with open(header, "r") as f:
+			with open(header, "rb") as f:
 				source_code = f.read()
-				# Hack to fix tree-sitter parsing of GP_EXPORT
-				source_code = source_code.replace("GP_EXPORT", "")
-				print(f"Source code length: {len(source_code)}")
-				tree = parser.parse(bytes(source_code, "utf8"))
-				classes = walk_tree(header_filename, tree, bytes(source_code, "utf8"))
-				print(f"Found {len(classes)} class(es) in {header}!")
-				all_classes += classes
-
-				main_class = None
-				base_path, base_filename = os.path.split(header)
-				base_filename, base_extension = os.path.splitext(base_filename)
-				for class_info in classes:
-					class_info.resolve()
-					if class_info.name == base_filename:
-						main_class = class_info
-
-				if main_class:
-					generate_header(template_path, generated_dir, header, main_class)
-				else:
-					print(f"No main class found in {header}!")
+			source_hash = content_hash(source_code)
+			header_entries.append((header, header_filename, source_hash))
+			cached = cached_headers.get(header_filename)
+			if not cached or cached[0] != source_hash:
+				print(f"Parsing {header}")
+				jobs.append((header_filename, source_code))
+
+	parsed = dict(parse_headers(jobs))
+	print(f"Parsed {len(jobs)} changed header(s), reused {len(header_entries) - len(jobs)} from cache.")
+
+	all_classes = []
+	main_classes = []
+	headers = dict()
+	for header, header_filename, source_hash in header_entries:
+		if header_filename in parsed:
+			classes = parsed[header_filename]
+		else:
+			classes = cached_headers[header_filename][1]
+		headers[header_filename] = (source_hash, classes)
+		all_classes += classes
+
+		main_class = None
+		base_path, base_filename = os.path.split(header)
+		base_filename, base_extension = os.path.splitext(base_filename)
+		for class_info in classes:
+			if class_info.name == base_filename:
+				main_class = class_info
+
+		if filenames and not any(fn in header_filename for fn in filenames):
+			continue
+		if main_class:
+			main_classes.append((header, main_class))
+		else:
+			print(f"No main class found in {header}!")
+	#saved before anything else touches the classes. headers that were deleted drop out of the cache here
+	if len(jobs) > 0 or len(headers) != len(cached_headers):
+		save_parse_cache(cache_path, fingerprint, headers)
+
+	written = 0
+	for header, main_class in main_classes:
+		if generate_header(template_path, generated_dir, header, main_class, all_classes):
+			written += 1
+	print(f"Regenerated {written} of {len(main_classes)} header(s).")
 
 	reflection_header_filename = os.path.join(generated_dir, "ReflectionRegistry.h")
-	with open(reflection_header_filename, "w") as file:
-		class_registration_str = ""
-		class_includes_str = ""
-		for class_info in all_classes:
-			class_header_dir, class_header_file = os.path.split(class_info.header)
-			class_header_base, class_header_ext = os.path.splitext(class_header_file)
-
-			class_includes_str += f"#include \"{class_info.header}\"\n"
-			class_includes_str += f"#include \"{class_header_base}.generated.h\"\n"
-			class_registration_str += f"\t\tReflection::register_{class_info.name}();\n"
-
-		file.write(f"""
+	class_includes_str = ""
+	registered_classes = dict()
+	for class_info in all_classes:
+		class_header_dir, class_header_file = os.path.split(class_info.header)
+		class_header_base, class_header_ext = os.path.splitext(class_header_file)
+
+		class_includes_str += f"#include \"{class_info.header}\"\n"
+		class_includes_str += f"#include \"{class_header_base}.generated.h\"\n"
+		registered_classes.setdefault(class_info.hash, class_info)
+
+	#the registry binary-searches these, so they are sorted here rather than at startup.
+	#names compare bytewise, the same as std::string_view.
+	by_id = sorted(registered_classes.values(), key=lambda c: c.hash)
+	by_name = sorted(registered_classes.values(), key=lambda c: c.name.encode())
+	by_id_str = "".join(f"\t\t{{ {c.hash}ULL, &reflected_{c.get_sanitized_name()} }},\n" for c in by_id)
+	by_name_str = "".join(f"\t\t{{ \"{c.name}\", &reflected_{c.get_sanitized_name()} }},\n" for c in by_name)
+
+	write_if_changed(reflection_header_filename, f"""
 {class_includes_str}
 
 namespace Reflection {{
+	inline constexpr ClassIdEntry generatedClassesById[] = {{
+{by_id_str}\t}};
+	inline constexpr ClassNameEntry generatedClassesByName[] = {{
+{by_name_str}\t}};
+
 	static void registerAllClasses() {{
-{class_registration_str}
+		Reflection::GetRegistry().Install(generatedClassesById, generatedClassesByName);
+		Reflection::GetRegistry().Finalize();
 	}}
 }}
 """)
@@ -911,9 +1249,7 @@ namespace Reflection {{
 	json_data = json.dumps(all_classes, cls=ReflectionEncoder, indent=4)
 
 	json_pack_filename = "Generated/reflection_data.json"
-	with open(json_pack_filename, "w") as file:
-		file.write(json_data)
-		print(f"Wrote {len(json_data)} bytes to {json_pack_filename}.")
+	write_if_changed(json_pack_filename, json_data)
 
 #todo:
 # generate setter/getters for props that don't have them so raisePropChanged still gets called
@@ -50,9 +50,8 @@ DirectorySubscription* WindowsFileSystemWatcher::Subscribe(const std::string& di
         throw std::runtime_error("Directory does not exist: " + directory);
     }
 
-    DirectorySubscription subscription;
+    DirectorySubscription& subscription = subscriptions[directory];
     subscription.directory = directory;
-    subscriptions[directory] = subscription;
 
     std::shared_ptr<std::atomic<bool>> running = std::make_shared<std::atomic<bool>>(true);
     auto directoryWatchEntry = directoryWatches.try_emplace(directory);